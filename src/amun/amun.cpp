@@ -21,10 +21,12 @@
 #include "amun.h"
 #include "receiver.h"
 #include "core/timer.h"
+#include "protobuf/configversion.h"
 #include "processor/processor.h"
 #include "processor/transceiver.h"
 #include "processor/networktransceiver.h"
 #include "simulator/simulator.h"
+#include "statusserver.h"
 #include "strategy/strategy.h"
 #include "networkinterfacewatcher.h"
 #include <QMetaType>
@@ -60,6 +62,7 @@ Amun::Amun(QObject *parent) :
     m_simulator(NULL),
     m_referee(NULL),
     m_vision(NULL),
+    m_statusServer(NULL),
     m_simulatorEnabled(false),
     m_scaling(1.0f),
     m_useNetworkTransceiver(false)
@@ -69,6 +72,8 @@ Amun::Amun(QObject *parent) :
     qRegisterMetaType< QList<robot::RadioCommand> >("QList<robot::RadioCommand>");
     qRegisterMetaType< QList<robot::RadioResponse> >("QList<robot::RadioResponse>");
     qRegisterMetaType<Status>("Status");
+    qRegisterMetaType< QList<QByteArray> >("QList<QByteArray>");
+    qRegisterMetaType< QList<qint64> >("QList<qint64>");
 
     m_strategy[0] = NULL;
     m_strategy[1] = NULL;
@@ -139,7 +144,7 @@ void Amun::start()
     // create referee
     setupReceiver(m_referee, QHostAddress("224.5.23.1"), 10003);
     // move referee packets to processor
-    connect(m_referee, SIGNAL(gotPacket(QByteArray, qint64)), m_processor, SLOT(handleRefereePacket(QByteArray, qint64)));
+    connect(m_referee, SIGNAL(gotPackets(QList<QByteArray>, QList<qint64>)), m_processor, SLOT(handleRefereePackets(QList<QByteArray>, QList<qint64>)));
 
     // create vision
     setupReceiver(m_vision, QHostAddress("224.5.23.2"), 10002);
@@ -151,12 +156,12 @@ void Amun::start()
     // create network radio protocol receiver
     setupReceiver(m_networkCommand, QHostAddress(), 10010);
     // pass packets to processor
-    connect(m_networkCommand, SIGNAL(gotPacket(QByteArray, qint64)), m_processor, SLOT(handleNetworkCommand(QByteArray, qint64)));
+    connect(m_networkCommand, SIGNAL(gotPackets(QList<QByteArray>, QList<qint64>)), m_processor, SLOT(handleNetworkCommands(QList<QByteArray>, QList<qint64>)));
 
     // create mixed team information receiver
     setupReceiver(m_mixedTeam, QHostAddress(), 10012);
     // pass packets to processor
-    connect(m_mixedTeam, SIGNAL(gotPacket(QByteArray,qint64)), m_processor, SLOT(handleMixedTeamInfo(QByteArray, qint64)));
+    connect(m_mixedTeam, SIGNAL(gotPackets(QList<QByteArray>, QList<qint64>)), m_processor, SLOT(handleMixedTeamInfos(QList<QByteArray>, QList<qint64>)));
 
     // create simulator
     Q_ASSERT(m_simulator == NULL);
@@ -169,6 +174,14 @@ void Amun::start()
     // propagate time scaling
     connect(this, SIGNAL(setScaling(float)), m_simulator, SLOT(setScaling(float)));
 
+    // serve the status stream to remote clients, off the processing threads
+    Q_ASSERT(m_statusServer == NULL);
+    m_statusServer = new StatusServer;
+    m_statusServer->moveToThread(m_networkThread);
+    connect(this, SIGNAL(gotCommand(Command)), m_statusServer, SLOT(handleCommand(Command)));
+    connect(this, SIGNAL(sendStatus(Status)), m_statusServer, SLOT(handleStatus(Status)));
+    connect(m_statusServer, SIGNAL(sendStatus(Status)), SLOT(handleStatus(Status)));
+
     Q_ASSERT(m_transceiver == NULL);
     m_transceiver = new Transceiver();
     m_transceiver->moveToThread(m_processorThread);
@@ -238,6 +251,9 @@ void Amun::stop()
     delete m_mixedTeam;
     m_mixedTeam = NULL;
 
+    delete m_statusServer;
+    m_statusServer = NULL;
+
     for (int i = 0; i < 2; i++) {
         delete m_strategy[i];
         m_strategy[i] = NULL;
@@ -263,8 +279,23 @@ void Amun::setupReceiver(Receiver *&receiver, const QHostAddress &address, quint
  * \brief Process a command
  * \param command Command to process
  */
-void Amun::handleCommand(const Command &command)
+void Amun::handleCommand(const Command &c)
 {
+    Command command = c;
+    // stamp team changes, the consumers then only compare the versions
+    if (command->has_set_team_blue() || command->has_set_team_yellow()) {
+        // don't modify the message of the sender
+        command = Command(new amun::Command(*c));
+        if (command->has_set_team_blue()) {
+            configVersionUpdate(&m_teamBlueVersion, command->set_team_blue());
+            command->mutable_team_blue_version()->CopyFrom(m_teamBlueVersion);
+        }
+        if (command->has_set_team_yellow()) {
+            configVersionUpdate(&m_teamYellowVersion, command->set_team_yellow());
+            command->mutable_team_yellow_version()->CopyFrom(m_teamYellowVersion);
+        }
+    }
+
     if (command->has_simulator()) {
         if (command->simulator().has_enable()) {
             setSimulatorEnabled(command->simulator().enable(), m_useNetworkTransceiver);
@@ -350,8 +381,8 @@ void Amun::setSimulatorEnabled(bool enabled, bool useNetworkTransceiver)
         connect(m_processor, SIGNAL(sendRadioCommands(QList<robot::RadioCommand>)),
                 m_simulator, SLOT(handleRadioCommands(QList<robot::RadioCommand>)));
     } else {
-        connect(m_vision, SIGNAL(gotPacket(QByteArray, qint64)),
-                m_processor, SLOT(handleVisionPacket(QByteArray,qint64)));
+        connect(m_vision, SIGNAL(gotPackets(QList<QByteArray>, QList<qint64>)),
+                m_processor, SLOT(handleVisionPackets(QList<QByteArray>, QList<qint64>)));
         if (!useNetworkTransceiver) {
             connect(m_transceiver, SIGNAL(sendRadioResponses(QList<robot::RadioResponse>)),
                     m_processor, SLOT(handleRadioResponses(QList<robot::RadioResponse>)));
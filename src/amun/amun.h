@@ -28,6 +28,7 @@ class NetworkInterfaceWatcher;
 class Processor;
 class Receiver;
 class Simulator;
+class StatusServer;
 class Strategy;
 class Timer;
 class Transceiver;
@@ -77,12 +78,15 @@ private:
     Receiver *m_vision;
     Receiver *m_networkCommand;
     Receiver *m_mixedTeam;
+    StatusServer *m_statusServer;
     Strategy *m_strategy[2];
     qint64 m_lastTime;
     Timer *m_timer;
     bool m_simulatorEnabled;
     float m_scaling;
     bool m_useNetworkTransceiver;
+    world::ConfigVersion m_teamBlueVersion;
+    world::ConfigVersion m_teamYellowVersion;
 
     NetworkInterfaceWatcher *m_networkInterfaceWatcher;
 };
@@ -21,6 +21,7 @@
 
 #include "controller.h"
 #include "debughelper.h"
+#include "mpc.h"
 #include "protobuf/debug.pb.h"
 #include "protobuf/world.pb.h"
 #include <cmath>
@@ -86,7 +87,7 @@ void Controller::calculateCommand(const world::Robot &robot, qint64 world_time,
         if (!command.direct()) {
             // get the desired state from the manual commands
             getDesiredState_ManualControl(robot, command);
-            controlAlgorithm(robot, world_time, command, debug);
+            controlAlgorithm(robot, world_time, command, debug, false);
         }
 
         // In case of manual control we are done.
@@ -112,7 +113,7 @@ void Controller::calculateCommand(const world::Robot &robot, qint64 world_time,
     if (current_index >= 0) {
         // Evaluate the spline part in order to generate desired states
         getDesiredState_AutomaticControl(m_input.spline(current_index), timeElapsed);
-        controlAlgorithm(robot, world_time, command, debug);
+        controlAlgorithm(robot, world_time, command, debug, m_specs.controller().use_mpc());
     }
 }
 
@@ -124,8 +125,9 @@ void Controller::calculateCommand(const world::Robot &robot, qint64 world_time,
  * \param world_time Current world time
  * \param command Reference to command to be written
  * \param debug Pointer to amun::DebugValues to be used as debugging interface
+ * \param predictive Optimize the accelerations over the upcoming part of the spline
  */
-void Controller::controlAlgorithm(const world::Robot &robot, qint64 world_time, robot::Command &command, amun::DebugValues *debug)
+void Controller::controlAlgorithm(const world::Robot &robot, qint64 world_time, robot::Command &command, amun::DebugValues *debug, bool predictive)
 {
     // abort if desired state is invalid
     if (std::isnan(m_p_x_d) || std::isinf(m_p_x_d) || std::isnan(m_p_y_d) || std::isinf(m_p_y_d)
@@ -188,18 +190,23 @@ void Controller::controlAlgorithm(const world::Robot &robot, qint64 world_time,
 
     // 4.) Controller logic implementation, exact linearization (Simon)
     // controller output is accelerations; Controller parameters as set by GUI (m_specs.controller().k_...() )
-    float a_x = m_specs.controller().use_ff() * m_a_x_d           // feed-forward
-                + error_x * m_specs.controller().k_xy()         // state-controller, position error ("P")
-                + error_vx * m_specs.controller().k_v_xy()      // state-controller, velocity error ("D")
-                + m_error_i_x * m_specs.controller().k_i_xy();    // state-controller, integral position error ("I")
-    float a_y = m_specs.controller().use_ff() * m_a_y_d
-                + error_y * m_specs.controller().k_xy()
-                + error_vy * m_specs.controller().k_v_xy()
-                + m_error_i_y * m_specs.controller().k_i_xy();
-    float a_phi = m_specs.controller().use_ff() * m_a_phi_d
-                + error_phi * m_specs.controller().k_phi()
-                + error_omega * m_specs.controller().k_omega()
-                + m_error_i_phi * m_specs.controller().k_i_phi();
+    float a_x, a_y, a_phi;
+    if (predictive) {
+        predictiveControl(robot, (world_time - m_startTime) / 1E9, a_x, a_y, a_phi);
+    } else {
+        a_x = m_specs.controller().use_ff() * m_a_x_d           // feed-forward
+                    + error_x * m_specs.controller().k_xy()         // state-controller, position error ("P")
+                    + error_vx * m_specs.controller().k_v_xy()      // state-controller, velocity error ("D")
+                    + m_error_i_x * m_specs.controller().k_i_xy();    // state-controller, integral position error ("I")
+        a_y = m_specs.controller().use_ff() * m_a_y_d
+                    + error_y * m_specs.controller().k_xy()
+                    + error_vy * m_specs.controller().k_v_xy()
+                    + m_error_i_y * m_specs.controller().k_i_xy();
+        a_phi = m_specs.controller().use_ff() * m_a_phi_d
+                    + error_phi * m_specs.controller().k_phi()
+                    + error_omega * m_specs.controller().k_omega()
+                    + m_error_i_phi * m_specs.controller().k_i_phi();
+    }
 
     // perform exact-state-linearization; time constants as set by GUI (m_specs.controller().t_...() )
     float output_v_s = (cos(robot_phi) - m_specs.controller().t_v_xy()*robot.omega()*sin(robot_phi))*robot.v_x()
@@ -280,6 +287,123 @@ void Controller::getDesiredState_AutomaticControl(const robot::Spline &spline, c
     m_a_phi_d = 2 * spline.phi().a2() + 6 * spline.phi().a3() * t;
 }
 
+/*!
+ * \brief Find the spline part to use for evaluation at time t
+ * \param t time in seconds since spline was set, clamped to the end of the spline
+ * \return Spline part covering t or NULL if there is none
+ */
+const robot::Spline *Controller::splineAt(float &t) const
+{
+    for (int i = 0; i < m_input.spline_size(); i++) {
+        const robot::Spline &spline = m_input.spline(i);
+        if (spline.t_start() <= t && t < spline.t_end()) {
+            return &spline;
+        }
+    }
+
+    // hold the final state once the spline has ended
+    if (m_input.spline_size() > 0 && t >= m_input.spline(m_input.spline_size() - 1).t_end()) {
+        const robot::Spline &spline = m_input.spline(m_input.spline_size() - 1);
+        t = spline.t_end();
+        return &spline;
+    }
+    return NULL;
+}
+
+static float evalPosition(const robot::Polynomial &p, float t)
+{
+    return p.a0() + (p.a1() + (p.a2() + p.a3() * t) * t) * t;
+}
+
+static float evalVelocity(const robot::Polynomial &p, float t)
+{
+    return p.a1() + (2 * p.a2() + 3 * p.a3() * t) * t;
+}
+
+static void accelerationBounds(float v, float speedupLimit, float brakeLimit, float &lower, float &upper)
+{
+    // speeding up in the direction of motion is limited stronger than braking
+    if (v >= 0) {
+        lower = -brakeLimit;
+        upper = speedupLimit;
+    } else {
+        lower = -speedupLimit;
+        upper = brakeLimit;
+    }
+}
+
+/*!
+ * \brief Calculate accelerations by optimizing over the upcoming part of the spline
+ *
+ * The problem is solved in robot coordinates as the acceleration limits are
+ * given for the local axes. The orientation is assumed to stay constant
+ * over the short horizon.
+ *
+ * \param robot Constant reference to current robot state
+ * \param t time in seconds since spline was set
+ * \param a_x Acceleration in x-direction (global coordinates)
+ * \param a_y Acceleration in y-direction (global coordinates)
+ * \param a_phi Rotational acceleration
+ */
+void Controller::predictiveControl(const world::Robot &robot, float t, float &a_x, float &a_y, float &a_phi) const
+{
+    const robot::LimitParameters &limits = m_specs.acceleration();
+    const float robot_phi = robot.phi() - M_PI_2;
+    const float c = std::cos(robot_phi);
+    const float s = std::sin(robot_phi);
+
+    // the reference orientation may be off by multiples of 2 pi
+    float error_phi = m_phi_d - robot.phi();
+    float phi_offset = -robot.phi();
+    while (error_phi > M_PI) {
+        error_phi -= 2*M_PI;
+        phi_offset -= 2*M_PI;
+    }
+    while (error_phi <= -M_PI) {
+        error_phi += 2*M_PI;
+        phi_offset += 2*M_PI;
+    }
+
+    // reference relative to the robot at the end of each horizon step
+    Mpc::Vector p_s, p_f, p_phi, v_s, v_f, v_phi;
+    Mpc::Vector min_s, max_s, min_f, max_f, min_phi, max_phi;
+    for (int k = 0; k < Mpc::HORIZON; k++) {
+        float t_k = t + (k + 1) * Mpc::TIMESTEP;
+        const robot::Spline *spline = splineAt(t_k);
+        if (spline) {
+            const float d_x = evalPosition(spline->x(), t_k) - robot.p_x();
+            const float d_y = evalPosition(spline->y(), t_k) - robot.p_y();
+            const float v_x = evalVelocity(spline->x(), t_k);
+            const float v_y = evalVelocity(spline->y(), t_k);
+            p_s(k) = c * d_x + s * d_y;
+            p_f(k) = -s * d_x + c * d_y;
+            p_phi(k) = evalPosition(spline->phi(), t_k) + phi_offset;
+            v_s(k) = c * v_x + s * v_y;
+            v_f(k) = -s * v_x + c * v_y;
+            v_phi(k) = evalVelocity(spline->phi(), t_k);
+        } else {
+            // gap in the spline, keep the previous reference
+            p_s(k) = (k > 0) ? p_s(k - 1) : 0;
+            p_f(k) = (k > 0) ? p_f(k - 1) : 0;
+            p_phi(k) = (k > 0) ? p_phi(k - 1) : error_phi;
+            v_s(k) = v_f(k) = v_phi(k) = 0;
+        }
+
+        accelerationBounds(v_s(k), limits.a_speedup_s_max(), limits.a_brake_s_max(), min_s(k), max_s(k));
+        accelerationBounds(v_f(k), limits.a_speedup_f_max(), limits.a_brake_f_max(), min_f(k), max_f(k));
+        accelerationBounds(v_phi(k), limits.a_speedup_phi_max(), limits.a_brake_phi_max(), min_phi(k), max_phi(k));
+    }
+
+    const float robot_v_s = c * robot.v_x() + s * robot.v_y();
+    const float robot_v_f = -s * robot.v_x() + c * robot.v_y();
+    const float a_s = Mpc::solve(0, robot_v_s, p_s, v_s, min_s, max_s);
+    const float a_f = Mpc::solve(0, robot_v_f, p_f, v_f, min_f, max_f);
+    a_phi = Mpc::solve(0, robot.omega(), p_phi, v_phi, min_phi, max_phi);
+
+    a_x = c * a_s - s * a_f;
+    a_y = s * a_s + c * a_f;
+}
+
 //-------------- util functions ---------------------
 /*!
  * \brief Helper function to draw a spline.
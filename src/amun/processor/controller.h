@@ -45,9 +45,11 @@ public:
     const robot::Specs& specs() const { return m_specs; }
 
 private:
-    void controlAlgorithm(const world::Robot &robot, qint64 world_time, robot::Command &command, amun::DebugValues *debug);
+    void controlAlgorithm(const world::Robot &robot, qint64 world_time, robot::Command &command, amun::DebugValues *debug, bool predictive);
+    void predictiveControl(const world::Robot &robot, float t, float &a_x, float &a_y, float &a_phi) const;
     void getDesiredState_ManualControl(const world::Robot &robot, const robot::Command &command);
     void getDesiredState_AutomaticControl(const robot::Spline &spline, const float t);
+    const robot::Spline *splineAt(float &t) const;
 
     //----------- misc helper functions ----------------
     void drawSpline(amun::DebugValues *debug, const google::protobuf::RepeatedPtrField<robot::Spline> &input);
@@ -0,0 +1,131 @@
+/***************************************************************************
+ *   Copyright 2016 Robotics Erlangen e.V.                                 *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include "mpc.h"
+#include <cmath>
+
+/*!
+ * \class Mpc
+ * \ingroup processor
+ * \brief Allocation-free solver for the trajectory following problem of a single axis
+ *
+ * The axis is modeled as double integrator with the acceleration as input.
+ * The cost penalizes position and velocity deviations from the reference at
+ * every step of the horizon as well as the applied accelerations. As the
+ * horizon and the weights are fixed at compile time, the condensed QP only
+ * differs in its linear term, which allows to precompute everything else.
+ */
+
+const float Mpc::TIMESTEP = 0.02f;
+
+// weights of the cost function
+static const float POSITION_WEIGHT = 1E4f;
+static const float VELOCITY_WEIGHT = 1E2f;
+static const float ACCELERATION_WEIGHT = 1.f;
+
+// iterations of the projected gradient method, used if the constraints are active
+static const int ITERATIONS = 15;
+
+struct Mpc::Problem
+{
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    Problem();
+
+    //! Maps the gradient of the position / velocity error onto the inputs
+    Matrix positionGradient;
+    Matrix velocityGradient;
+    //! Hessian of the cost function and its inverse
+    Matrix hessian;
+    Matrix hessianInverse;
+    //! Steplength of the gradient method, the inverse of the largest eigenvalue
+    float step;
+};
+
+Mpc::Problem::Problem()
+{
+    // influence of the acceleration at step j on the position / velocity at the end of step k
+    Matrix positionInput = Matrix::Zero();
+    Matrix velocityInput = Matrix::Zero();
+    for (int k = 0; k < HORIZON; k++) {
+        for (int j = 0; j <= k; j++) {
+            positionInput(k, j) = TIMESTEP * TIMESTEP * (k - j + 0.5f);
+            velocityInput(k, j) = TIMESTEP;
+        }
+    }
+
+    positionGradient = POSITION_WEIGHT * positionInput.transpose();
+    velocityGradient = VELOCITY_WEIGHT * velocityInput.transpose();
+    hessian = positionGradient * positionInput + velocityGradient * velocityInput
+            + ACCELERATION_WEIGHT * Matrix::Identity();
+    hessianInverse = hessian.inverse();
+
+    Eigen::SelfAdjointEigenSolver<Matrix> solver(hessian, Eigen::EigenvaluesOnly);
+    step = 1.f / solver.eigenvalues().maxCoeff();
+}
+
+const Mpc::Problem &Mpc::problem()
+{
+    // only built once, initialization is thread-safe
+    static const Problem p;
+    return p;
+}
+
+/*!
+ * \brief Calculate the optimal acceleration for the next step
+ * \param p0 Current position
+ * \param v0 Current velocity
+ * \param pRef Reference position at the end of each horizon step
+ * \param vRef Reference velocity at the end of each horizon step
+ * \param aMin Lower acceleration bound for each step
+ * \param aMax Upper acceleration bound for each step
+ * \return Acceleration to apply during the first step
+ */
+float Mpc::solve(float p0, float v0, const Vector &pRef, const Vector &vRef,
+                 const Vector &aMin, const Vector &aMax)
+{
+    const Problem &p = problem();
+
+    // deviation of the unforced motion from the reference
+    Vector positionError;
+    for (int k = 0; k < HORIZON; k++) {
+        positionError(k) = p0 + v0 * TIMESTEP * (k + 1) - pRef(k);
+    }
+    const Vector velocityError = Vector::Constant(v0) - vRef;
+    const Vector gradient = p.positionGradient * positionError + p.velocityGradient * velocityError;
+
+    Vector a = -p.hessianInverse * gradient;
+    if ((a.array() >= aMin.array()).all() && (a.array() <= aMax.array()).all()) {
+        return a(0);
+    }
+
+    // accelerated projected gradient, starting at the clamped unconstrained optimum
+    a = a.cwiseMax(aMin).cwiseMin(aMax);
+    Vector y = a;
+    float t = 1.f;
+    for (int i = 0; i < ITERATIONS; i++) {
+        const Vector next = (y - p.step * (p.hessian * y + gradient)).cwiseMax(aMin).cwiseMin(aMax);
+        const float tNext = (1.f + std::sqrt(1.f + 4.f * t * t)) / 2.f;
+        y = next + ((t - 1.f) / tNext) * (next - a);
+        a = next;
+        t = tNext;
+    }
+    return a(0);
+}
@@ -0,0 +1,47 @@
+/***************************************************************************
+ *   Copyright 2016 Robotics Erlangen e.V.                                 *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef MPC_H
+#define MPC_H
+
+#include <Eigen/Dense>
+
+//! Box-constrained linear model predictive control of a double integrator
+class Mpc
+{
+public:
+    //! Number of steps in the prediction horizon
+    static const int HORIZON = 10;
+    //! Duration of a single horizon step in s
+    static const float TIMESTEP;
+
+    typedef Eigen::Matrix<float, HORIZON, 1> Vector;
+    typedef Eigen::Matrix<float, HORIZON, HORIZON> Matrix;
+
+public:
+    static float solve(float p0, float v0, const Vector &pRef, const Vector &vRef,
+                       const Vector &aMin, const Vector &aMax);
+
+private:
+    struct Problem;
+    static const Problem &problem();
+};
+
+#endif // MPC_H
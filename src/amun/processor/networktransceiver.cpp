@@ -19,7 +19,6 @@
  ***************************************************************************/
 #include "networktransceiver.h"
 #include "core/timer.h"
-#include "protobuf/ssl_radio_protocol.pb.h"
 #include <QUdpSocket>
 
 NetworkTransceiver::NetworkTransceiver(QObject *parent) : QObject(parent),
@@ -37,9 +36,10 @@ void NetworkTransceiver::handleRadioCommands(const QList<robot::RadioCommand> &c
     const qint64 transceiver_start = Timer::systemTime();
 
     // charging the condensator can be enabled / disable separately
-    SSL_RadioProtocolWrapper wrapper;
+    // clearing keeps the allocated commands for reuse
+    m_wrapper.Clear();
     foreach (const robot::RadioCommand &robot, commands) {
-        SSL_RadioProtocolCommand *cmd = wrapper.add_command();
+        SSL_RadioProtocolCommand *cmd = m_wrapper.add_command();
         cmd->set_robot_id(robot.id());
         cmd->set_velocity_x(robot.command().v_f());
         cmd->set_velocity_y(-robot.command().v_s());
@@ -58,12 +58,10 @@ void NetworkTransceiver::handleRadioCommands(const QList<robot::RadioCommand> &c
 
     bool sendingSuccessful = false;
     if (m_configuration.IsInitialized()) {
-        QHostAddress address(QString::fromStdString(m_configuration.host()));
-
-        QByteArray data;
-        data.resize(wrapper.ByteSize());
-        if (wrapper.SerializeToArray(data.data(), data.size())) {
-            sendingSuccessful = m_udpSocket->writeDatagram(data, address, m_configuration.port()) == data.size();
+        // only grows the buffer if required
+        m_buffer.resize(m_wrapper.ByteSize());
+        if (m_wrapper.SerializeToArray(m_buffer.data(), m_buffer.size())) {
+            sendingSuccessful = m_udpSocket->writeDatagram(m_buffer, m_address, m_configuration.port()) == m_buffer.size();
         }
     }
 
@@ -90,6 +88,7 @@ void NetworkTransceiver::handleCommand(const Command &command)
 
         if (t.has_network_configuration()) {
             m_configuration = t.network_configuration();
+            m_address = QHostAddress(QString::fromStdString(m_configuration.host()));
         }
 
         if (t.has_enable()) {
@@ -20,10 +20,12 @@
 #ifndef NETWORKTRANSCEIVER_H
 #define NETWORKTRANSCEIVER_H
 
+#include <QHostAddress>
 #include <QObject>
 
 #include "protobuf/command.h"
 #include "protobuf/status.h"
+#include "protobuf/ssl_radio_protocol.pb.h"
 
 class QUdpSocket;
 
@@ -45,7 +47,11 @@ private:
     bool m_charge;
     bool m_simulatorEnabled;
     amun::HostAddress m_configuration;
+    QHostAddress m_address;
     QUdpSocket *m_udpSocket;
+    // reused for every packet to avoid allocations
+    SSL_RadioProtocolWrapper m_wrapper;
+    QByteArray m_buffer;
 };
 
 #endif // NETWORKTRANSCEIVER_H
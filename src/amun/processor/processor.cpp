@@ -25,7 +25,11 @@
 #include "referee.h"
 #include "core/timer.h"
 #include "tracking/tracker.h"
+#include <algorithm>
 #include <cmath>
+#include <functional>
+#include <QRunnable>
+#include <QThreadPool>
 #include <QTimer>
 
 struct Processor::Robot
@@ -93,12 +97,14 @@ Processor::Processor(const Timer *timer) :
     m_networkCommandTime(0),
     m_refereeInternalActive(false),
     m_simulatorEnabled(false),
-    m_transceiverEnabled(false)
+    m_transceiverEnabled(false),
+    m_controllerWork(0)
 {
     // keep two separate referee states
     m_referee = new Referee(false);
     m_refereeInternal = new Referee(true);
     m_tracker = new Tracker;
+    m_controllerPool = new QThreadPool(this);
 
     // start processing
     m_trigger = new QTimer(this);
@@ -130,9 +136,10 @@ void Processor::process()
 
     // run tracking
     m_tracker->process(current_time);
-    Status status = m_tracker->worldState(current_time);
+    Status status(new amun::Status);
     // prediction which accounts for the strategy runtime
-    Status strategyStatus = m_tracker->worldState(current_time + tickDuration);
+    Status strategyStatus(new amun::Status);
+    m_tracker->worldState(current_time, current_time + tickDuration, status, strategyStatus);
 
     // add information, about whether the world state is from the simulator or not
     status->mutable_world_state()->set_is_simulated(m_simulatorEnabled);
@@ -173,8 +180,14 @@ void Processor::process()
 
     // assume that current_time is still "now"
     const qint64 controllerTime = current_time + tickDuration;
-    processTeam(m_blueTeam, true, status->world_state().blue(), radio_commands, status_debug, controllerTime);
-    processTeam(m_yellowTeam, false, status->world_state().yellow(), radio_commands, status_debug, controllerTime);
+    m_controlJobs.resize(0);
+    prepareTeam(m_blueTeam, true, status->world_state().blue(), status_debug);
+    prepareTeam(m_yellowTeam, false, status->world_state().yellow(), status_debug);
+    runControllers(status_debug, controllerTime);
+    // keep the order of the radio commands independent of the controller scheduling
+    foreach (const ControlJob &job, m_controlJobs) {
+        radio_commands.append(*job.radioCommand);
+    }
 
     status_debug->mutable_timing()->set_controller((Timer::systemTime() - controller_start) / 1E9);
     emit sendStatus(status_debug);
@@ -186,17 +199,6 @@ void Processor::process()
     }
 }
 
-const world::Robot* Processor::getWorldRobot(const RobotList &robots, uint id) {
-    for (RobotList::const_iterator it = robots.begin(); it != robots.end(); ++it) {
-        const world::Robot &robot = *it;
-        if (robot.id() == id) {
-            return &robot;
-        }
-    }
-    // If no robot was found return null
-    return NULL;
-}
-
 void Processor::injectExtraData(Status &status)
 {
     // just copy every response
@@ -252,8 +254,13 @@ void Processor::injectUserControl(Status &status, bool isBlue)
     }
 }
 
-void Processor::processTeam(Team &team, bool isBlue, const RobotList &robots, QList<robot::RadioCommand> &radio_commands, Status &status, qint64 time)
+void Processor::prepareTeam(Team &team, bool isBlue, const RobotList &robots, Status &status)
 {
+    m_worldRobots.clear();
+    for (const world::Robot &robot: robots) {
+        m_worldRobots.insert(robot.id(), &robot);
+    }
+
     foreach (Robot *robot, team.robots) {
         robot::RadioCommand *radio_command = status->add_radio_command();
         radio_command->set_generation(robot->controller.specs().generation());
@@ -281,24 +288,86 @@ void Processor::processTeam(Team &team, bool isBlue, const RobotList &robots, QL
             command.set_eject_sdcard(true);
         }
 
+        ControlJob job;
+        job.robot = robot;
         // Get current robot
-        const world::Robot* currentRobot = getWorldRobot(robots, robot->controller.specs().id());
-        // only run controller if we know where the robot is
-        if (currentRobot) {
-            robot->controller.calculateCommand(*currentRobot, time, command, status->mutable_debug());
+        job.worldRobot = m_worldRobots.value(robot->controller.specs().id(), NULL);
+        job.radioCommand = radio_command;
+        job.duration = 0;
+        m_controlJobs.append(job);
+    }
+}
+
+namespace {
+class FunctionRunnable : public QRunnable
+{
+public:
+    explicit FunctionRunnable(const std::function<void()> &function) : m_function(function) {}
+    void run() override { m_function(); }
+
+private:
+    std::function<void()> m_function;
+};
+}
+
+void Processor::runControllers(Status &status, qint64 time)
+{
+    // distributing the robots only pays off for expensive controllers or many robots
+    const qint64 parallelWork = 500 * 1000;
+    const int threads = std::min(m_controllerPool->maxThreadCount(), m_controlJobs.size());
+    if (m_controllerWork < parallelWork || threads < 2) {
+        m_controllerWork = 0;
+        for (ControlJob &job: m_controlJobs) {
+            runController(job, time, status->mutable_debug());
+            m_controllerWork += job.duration;
         }
+        return;
+    }
 
-        // Limit acceleration and velocities (in global coordinates)
-        // if robot is invisible use local coordinates
-        updateCommandVGlobal(currentRobot, command);
-        robot->accelerator.limit(currentRobot, command, time, status->mutable_debug());
-        updateCommandVLocal(currentRobot, command);
+    // each thread handles every n-th robot and writes to the debug values of the job
+    ControlJob *jobs = m_controlJobs.data();
+    const int jobCount = m_controlJobs.size();
+    for (int t = 1; t < threads; t++) {
+        m_controllerPool->start(new FunctionRunnable([this, jobs, jobCount, t, threads, time]() {
+            for (int i = t; i < jobCount; i += threads) {
+                runController(jobs[i], time, &jobs[i].debug);
+            }
+        }));
+    }
+    for (int i = 0; i < jobCount; i += threads) {
+        runController(jobs[i], time, &jobs[i].debug);
+    }
+    m_controllerPool->waitForDone();
 
-        // Prepare radio command
-        radio_commands.append(*radio_command);
+    // merge in robot order to get a deterministic output
+    m_controllerWork = 0;
+    for (ControlJob &job: m_controlJobs) {
+        status->mutable_debug()->MergeFrom(job.debug);
+        m_controllerWork += job.duration;
     }
 }
 
+void Processor::runController(ControlJob &job, qint64 time, amun::DebugValues *debug)
+{
+    const qint64 start = Timer::systemTime();
+    Robot *robot = job.robot;
+    const world::Robot *currentRobot = job.worldRobot;
+    robot::Command &command = *job.radioCommand->mutable_command();
+
+    // only run controller if we know where the robot is
+    if (currentRobot) {
+        robot->controller.calculateCommand(*currentRobot, time, command, debug);
+    }
+
+    // Limit acceleration and velocities (in global coordinates)
+    // if robot is invisible use local coordinates
+    updateCommandVGlobal(currentRobot, command);
+    robot->accelerator.limit(currentRobot, command, time, debug);
+    updateCommandVLocal(currentRobot, command);
+
+    job.duration = Timer::systemTime() - start;
+}
+
 // Transform local robot coordinates to global field coordinates
 void Processor::updateCommandVGlobal(const world::Robot *robot, robot::Command &command) {
     float robot_phi = 0;
@@ -352,6 +421,34 @@ void Processor::handleMixedTeamInfo(const QByteArray &data, qint64 time)
     m_mixedTeamInfo.ParseFromArray(data.constData(), data.size());
 }
 
+void Processor::handleRefereePackets(const QList<QByteArray> &data, const QList<qint64> &times)
+{
+    for (int i = 0; i < data.size(); i++) {
+        handleRefereePacket(data.at(i), times.at(i));
+    }
+}
+
+void Processor::handleVisionPackets(const QList<QByteArray> &data, const QList<qint64> &times)
+{
+    for (int i = 0; i < data.size(); i++) {
+        handleVisionPacket(data.at(i), times.at(i));
+    }
+}
+
+void Processor::handleNetworkCommands(const QList<QByteArray> &data, const QList<qint64> &times)
+{
+    for (int i = 0; i < data.size(); i++) {
+        handleNetworkCommand(data.at(i), times.at(i));
+    }
+}
+
+void Processor::handleMixedTeamInfos(const QList<QByteArray> &data, const QList<qint64> &times)
+{
+    for (int i = 0; i < data.size(); i++) {
+        handleMixedTeamInfo(data.at(i), times.at(i));
+    }
+}
+
 void Processor::handleRadioResponses(const QList<robot::RadioResponse> &responses)
 {
     // radio responses may arrive in multiple chunks between two
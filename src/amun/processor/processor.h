@@ -25,14 +25,17 @@
 #include "protobuf/ssl_mixed_team.pb.h"
 #include "protobuf/ssl_radio_protocol.pb.h"
 #include "protobuf/status.h"
+#include <QHash>
 #include <QMap>
 #include <QPair>
 #include <QObject>
+#include <QVector>
 
 class Controller;
 class Referee;
 class Timer;
 class Tracker;
+class QThreadPool;
 class QTimer;
 
 class Processor : public QObject
@@ -54,6 +57,10 @@ public slots:
     void handleVisionPacket(const QByteArray &data, qint64 time);
     void handleNetworkCommand(const QByteArray &data, qint64 time);
     void handleMixedTeamInfo(const QByteArray &data, qint64 time);
+    void handleRefereePackets(const QList<QByteArray> &data, const QList<qint64> &times);
+    void handleVisionPackets(const QList<QByteArray> &data, const QList<qint64> &times);
+    void handleNetworkCommands(const QList<QByteArray> &data, const QList<qint64> &times);
+    void handleMixedTeamInfos(const QList<QByteArray> &data, const QList<qint64> &times);
     void handleRadioResponses(const QList<robot::RadioResponse> &responses);
     void handleCommand(const Command &command);
     void handleStrategyCommand(bool blue, uint generation, uint id, QByteArray data, qint64 time);
@@ -66,6 +73,15 @@ private:
         robot::Team team;
         QMap<QPair<uint, uint>, Robot*> robots;
     };
+    struct ControlJob
+    {
+        Robot *robot;
+        const world::Robot *worldRobot;
+        robot::RadioCommand *radioCommand;
+        // only used if the controllers run in parallel
+        amun::DebugValues debug;
+        qint64 duration;
+    };
 
 private slots:
     void process();
@@ -74,11 +90,12 @@ private:
     typedef google::protobuf::RepeatedPtrField<world::Robot> RobotList;
 
     void setTeam(const robot::Team &t, Team &team);
-    void processTeam(Team &team, bool isBlue, const RobotList &robots, QList<robot::RadioCommand> &radio_commands, Status &status, qint64 time);
+    void prepareTeam(Team &team, bool isBlue, const RobotList &robots, Status &status);
+    void runControllers(Status &status, qint64 time);
+    void runController(ControlJob &job, qint64 time, amun::DebugValues *debug);
     void handleControl(Team &team, const amun::CommandControl &control);
     void updateCommandVGlobal(const world::Robot *robot, robot::Command &command);
     void updateCommandVLocal(const world::Robot *robot, robot::Command &command);
-    const world::Robot *getWorldRobot(const RobotList &robots, uint id);
     void injectExtraData(Status &status);
     void injectUserControl(Status &status, bool isBlue);
 
@@ -99,6 +116,11 @@ private:
 
     Team m_blueTeam;
     Team m_yellowTeam;
+    QHash<uint, const world::Robot*> m_worldRobots;
+    QVector<ControlJob> m_controlJobs;
+    QThreadPool *m_controllerPool;
+    // summed controller runtime of the last tick, in ns
+    qint64 m_controllerWork;
 
     bool m_transceiverEnabled;
 };
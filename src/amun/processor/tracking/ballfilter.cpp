@@ -78,6 +78,19 @@ void BallFilter::predict(qint64 time, bool cameraSwitched)
     const double timeDiff = (time  - m_lastTime) / 1E9;
     Q_ASSERT(timeDiff >= 0);
 
+    // frames of different cameras may share their capture time, the rolling
+    // friction and chip push aren't scaled by the time and must not be applied again
+    if (timeDiff == 0) {
+        m_kalman->F(0, 3) = 0;
+        m_kalman->F(1, 4) = 0;
+        m_kalman->F(2, 5) = 0;
+        m_kalman->B = m_kalman->F;
+        m_kalman->u = Kalman::Vector::Zero();
+        m_kalman->Q = Kalman::Matrix::Zero();
+        m_kalman->predict(false);
+        return;
+    }
+
     // used to update position with current speed
     m_kalman->F(0, 3) = timeDiff;
     m_kalman->F(1, 4) = timeDiff;
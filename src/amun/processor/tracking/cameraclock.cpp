@@ -0,0 +1,87 @@
+/***************************************************************************
+ *   Copyright 2016 Robotics Erlangen e.V.                                 *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include "cameraclock.h"
+
+/*!
+ * \class CameraClock
+ * \ingroup processor
+ * \brief Clock offset estimator for a single vision camera
+ *
+ * Each frame yields the difference between its local receive time and the
+ * send time stamped by the vision software. This is the clock offset plus
+ * the network and scheduling delay of that frame. The delay can only be
+ * positive, thus the minimum over a short window is the best estimate for
+ * the offset and is free of the delay jitter. The window still follows
+ * clock drift.
+ */
+
+// length of the window the minimum is taken over
+static const qint64 WINDOW = 1000 * 1000 * 1000LL;
+// the vision clock has probably been changed if the offset jumps that far
+static const qint64 MAX_JUMP = 1000 * 1000 * 1000LL;
+
+CameraClock::CameraClock()
+{
+}
+
+/*!
+ * \brief Add a frame and return the updated offset estimate
+ * \param sentTime Send timestamp of the frame in seconds, using the vision clock
+ * \param receiveTime Local receive time of the frame in nanoseconds
+ * \return Offset to add to vision timestamps to get local time, in nanoseconds
+ */
+qint64 CameraClock::update(double sentTime, qint64 receiveTime)
+{
+    const qint64 sampleOffset = receiveTime - qint64(sentTime * 1E9);
+
+    if (!m_samples.isEmpty() && qAbs(sampleOffset - offset()) > MAX_JUMP) {
+        reset();
+    }
+
+    // samples with a larger offset can't become the minimum anymore
+    while (!m_samples.isEmpty() && m_samples.last().offset >= sampleOffset) {
+        m_samples.removeLast();
+    }
+    Sample sample;
+    sample.receiveTime = receiveTime;
+    sample.offset = sampleOffset;
+    m_samples.append(sample);
+
+    // the newest sample is always kept
+    while (m_samples.first().receiveTime < receiveTime - WINDOW) {
+        m_samples.removeFirst();
+    }
+    return offset();
+}
+
+/*!
+ * \brief Current offset estimate
+ * \return Offset to add to vision timestamps to get local time, in nanoseconds
+ */
+qint64 CameraClock::offset() const
+{
+    return m_samples.isEmpty() ? 0 : m_samples.first().offset;
+}
+
+void CameraClock::reset()
+{
+    m_samples.clear();
+}
@@ -0,0 +1,49 @@
+/***************************************************************************
+ *   Copyright 2016 Robotics Erlangen e.V.                                 *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef CAMERACLOCK_H
+#define CAMERACLOCK_H
+
+#include <QList>
+#include <QtGlobal>
+
+//! Estimates the offset between the clock of a vision camera and the local clock
+class CameraClock
+{
+public:
+    CameraClock();
+
+public:
+    qint64 update(double sentTime, qint64 receiveTime);
+    qint64 offset() const;
+    void reset();
+
+private:
+    struct Sample
+    {
+        qint64 receiveTime;
+        qint64 offset;
+    };
+
+    // samples of the current window, the offsets are strictly increasing
+    QList<Sample> m_samples;
+};
+
+#endif // CAMERACLOCK_H
@@ -20,6 +20,7 @@
 
 #include "tracker.h"
 #include "ballfilter.h"
+#include "protobuf/configversion.h"
 #include "protobuf/ssl_wrapper.pb.h"
 #include "robotfilter.h"
 
@@ -63,6 +64,7 @@ void Tracker::reset()
     m_lastUpdateTime = 0;
     m_visionPackets.clear();
     m_radioCommands.clear();
+    m_cameraClocks.clear();
 }
 
 void Tracker::setFlip(bool flip)
@@ -114,6 +116,8 @@ void Tracker::process(qint64 currentTime)
             for (int i = 0; i < wrapper.geometry().calib_size(); ++i) {
                 updateCamera(wrapper.geometry().calib(i));
             }
+            // consumers only have to compare the version
+            configVersionUpdate(&m_geometryVersion, m_geometry);
             m_geometryUpdated = true;
         }
 
@@ -122,13 +126,15 @@ void Tracker::process(qint64 currentTime)
         }
 
         const SSL_DetectionFrame &detection = wrapper.detection();
-        const qint64 visionProcessingTime = (detection.t_sent() - detection.t_capture()) * 1E9;
+        // the estimated clock offset doesn't contain the delay jitter of the individual frame
+        const qint64 clockOffset = m_cameraClocks[detection.camera_id()].update(detection.t_sent(), p.second);
         // time on the field for which the frame was captured
         // with Timer::currentTime being now
-        const qint64 sourceTime = p.second - visionProcessingTime - m_systemDelay;
+        const qint64 sourceTime = qint64(detection.t_capture() * 1E9) + clockOffset - m_systemDelay;
 
         // drop frames older than the current state
-        if (sourceTime <= m_lastUpdateTime) {
+        // frames of different cameras may share their capture time
+        if (sourceTime < m_lastUpdateTime) {
             continue;
         }
 
@@ -167,47 +173,69 @@ Filter* Tracker::bestFilter(QList<Filter*> &filters, int minFrameCount)
     return NULL;
 }
 
-Status Tracker::worldState(qint64 currentTime)
+void Tracker::robotStates(RobotMap &map, int minFrameCount, qint64 currentTime, qint64 predictionTime,
+                          RobotList *robots, RobotList *predictedRobots)
 {
+    for(RobotMap::iterator it = map.begin(); it != map.end(); ++it) {
+        RobotFilter *robot = bestFilter(*it, minFrameCount);
+        if (robot != NULL) {
+            robot->update(currentTime);
+            world::Robot *current = robots->Add();
+            robot->get(current, m_flip, false);
+            // continue with the same filter state, only predicts the remaining time step
+            robot->update(predictionTime);
+            world::Robot *predicted = predictedRobots->Add();
+            robot->get(predicted, m_flip, true);
+            // strategies can access the raw data via amun.getWorldState
+            predicted->mutable_raw()->CopyFrom(current->raw());
+        }
+    }
+}
+
+/*!
+ * \brief Fills the world state for currentTime and the prediction for predictionTime
+ *
+ * Both states are taken from one pass over the filters, each filter is
+ * updated to currentTime and then extrapolated to predictionTime.
+ */
+void Tracker::worldState(qint64 currentTime, qint64 predictionTime, const Status &status, const Status &prediction)
+{
+    Q_ASSERT(predictionTime >= currentTime);
     const qint64 resetTimeout = 100*1000*1000;
     // only return objects which have been tracked for more than minFrameCount frames
     // if the tracker was reset recently, allow for fast repopulation
     const int minFrameCount = (currentTime > m_resetTime + resetTimeout) ? 5: 0;
 
-    // create world state for the given time
-    Status status(new amun::Status);
+    // create world states for the given times
     world::State *worldState = status->mutable_world_state();
     worldState->set_time(currentTime);
     worldState->set_has_vision_data(m_hasVisionData);
+    world::State *predictedState = prediction->mutable_world_state();
+    predictedState->set_time(predictionTime);
+    predictedState->set_has_vision_data(m_hasVisionData);
 
     // just return every ball that is available
     BallFilter *ball = bestFilter(m_ballFilter, 0);
     if (ball != NULL) {
         ball->update(currentTime);
         ball->get(worldState->mutable_ball(), m_flip, false);
+        ball->update(predictionTime);
+        ball->get(predictedState->mutable_ball(), m_flip, true);
+        // the raw data doesn't depend on the prediction time, reuse it
+        predictedState->mutable_ball()->mutable_raw()->CopyFrom(worldState->ball().raw());
     }
 
-    for(RobotMap::iterator it = m_robotFilterYellow.begin(); it != m_robotFilterYellow.end(); ++it) {
-        RobotFilter *robot = bestFilter(*it, minFrameCount);
-        if (robot != NULL) {
-            robot->update(currentTime);
-            robot->get(worldState->add_yellow(), m_flip, false);
-        }
-    }
-
-    for(RobotMap::iterator it = m_robotFilterBlue.begin(); it != m_robotFilterBlue.end(); ++it) {
-        RobotFilter *robot = bestFilter(*it, minFrameCount);
-        if (robot != NULL) {
-            robot->update(currentTime);
-            robot->get(worldState->add_blue(), m_flip, false);
-        }
-    }
+    robotStates(m_robotFilterYellow, minFrameCount, currentTime, predictionTime,
+                worldState->mutable_yellow(), predictedState->mutable_yellow());
+    robotStates(m_robotFilterBlue, minFrameCount, currentTime, predictionTime,
+                worldState->mutable_blue(), predictedState->mutable_blue());
 
     if (m_geometryUpdated) {
         status->mutable_geometry()->CopyFrom(m_geometry);
+        status->mutable_geometry_version()->CopyFrom(m_geometryVersion);
+        prediction->mutable_geometry()->CopyFrom(m_geometry);
+        prediction->mutable_geometry_version()->CopyFrom(m_geometryVersion);
     }
-
-    return status;
 }
 
 void Tracker::updateGeometry(const SSL_GeometryFieldSize &g)
@@ -21,6 +21,7 @@
 #ifndef TRACKER_H
 #define TRACKER_H
 
+#include "cameraclock.h"
 #include "protobuf/command.pb.h"
 #include "protobuf/status.h"
 #include "protobuf/world.pb.h"
@@ -41,6 +42,7 @@ class Tracker
 {
 private:
     typedef QMap<uint, QList<RobotFilter*> > RobotMap;
+    typedef google::protobuf::RepeatedPtrField<world::Robot> RobotList;
 
 public:
     Tracker();
@@ -48,7 +50,7 @@ public:
 
 public:
     void process(qint64 currentTime);
-    Status worldState(qint64 currentTime);
+    void worldState(qint64 currentTime, qint64 predictionTime, const Status &status, const Status &prediction);
 
     void setFlip(bool flip);
     void queuePacket(const QByteArray &packet, qint64 time);
@@ -65,6 +67,8 @@ private:
     void invalidateBall(qint64 currentTime);
     static void invalidateRobots(RobotMap &map, qint64 currentTime);
 
+    void robotStates(RobotMap &map, int minFrameCount, qint64 currentTime, qint64 predictionTime,
+                     RobotList *robots, RobotList *predictedRobots);
     QList<RobotFilter *> getBestRobots(qint64 currentTime);
     world::Robot findNearestRobot(const QList<RobotFilter *> &robots, const world::Ball &ball) const;
 
@@ -81,7 +85,9 @@ private:
     qint64 m_resetTime;
 
     world::Geometry m_geometry;
+    world::ConfigVersion m_geometryVersion;
     QMap<int, Eigen::Vector3f> m_cameraPosition;
+    QMap<int, CameraClock> m_cameraClocks;
     bool m_geometryUpdated;
     bool m_hasVisionData;
 
@@ -37,6 +37,10 @@ static_assert(sizeof(RadioResponse2014) == 10, "Expected radio response packet o
 
 const int PROTOCOL_VERSION = 2;
 
+// upper bounds of the response latency buckets, in s
+static const float LATENCY_LIMITS[] = { 0.002f, 0.004f, 0.006f, 0.008f, 0.010f, 0.015f, 0.020f, 0.030f, 0.050f };
+static_assert(sizeof(LATENCY_LIMITS) / sizeof(LATENCY_LIMITS[0]) == 10 - 1, "The last latency bucket must be unbounded");
+
 typedef struct
 {
     int64_t time;
@@ -46,6 +50,9 @@ typedef struct
 Transceiver::Transceiver(QObject *parent) :
     QObject(parent),
     m_charge(false),
+    m_statisticsFrames(0),
+    m_statisticsStart(0),
+    m_packetSize(0),
     m_packetCounter(0),
     m_context(nullptr),
     m_device(nullptr),
@@ -55,6 +62,9 @@ Transceiver::Transceiver(QObject *parent) :
     // default channel
     m_configuration.set_channel(10);
 
+    memset(m_frameTimes, 0, sizeof(m_frameTimes));
+    memset(m_usbQueueDepth, 0, sizeof(m_usbQueueDepth));
+
     m_timeoutTimer = new QTimer(this);
     connect(m_timeoutTimer, &QTimer::timeout, this, &Transceiver::timeout);
 }
@@ -76,6 +86,14 @@ void Transceiver::handleRadioCommands(const QList<robot::RadioCommand> &commands
     sendCommand(commands, m_charge);
 
     status->mutable_timing()->set_transceiver((Timer::systemTime() - transceiver_start) / 1E9);
+
+    // publish the radio link statistics once per second
+    if (m_statisticsStart == 0) {
+        m_statisticsStart = transceiver_start;
+    } else if (transceiver_start - m_statisticsStart >= 1000*1000*1000LL) {
+        addLinkStatistics(status.data());
+        m_statisticsStart = transceiver_start;
+    }
     emit sendStatus(status);
 }
 
@@ -128,7 +146,26 @@ void Transceiver::handleTeam(const robot::Team &team)
     for (int i = 0; i < team.robot_size(); ++i) {
         const robot::Specs &spec = team.robot(i);
         m_ir_param[qMakePair(spec.generation(), spec.id())] = spec.ir_param();
+        // prepare the headers, so that sending a command only has to copy them
+        m_robotHeaders[qMakePair(spec.generation(), spec.id())] = robotHeader(spec.generation(), spec.id());
+    }
+}
+
+Transceiver::RobotHeader Transceiver::robotHeader(uint generation, uint id)
+{
+    RobotHeader header;
+    header.command.command = COMMAND_SEND_NRF24;
+    if (generation == 2) {
+        header.command.size = sizeof(RadioCommand2012) + sizeof(TransceiverSendNRF24Packet);
+        memcpy(header.address.address, robot2012_address, sizeof(header.address.address));
+        header.address.expectedResponseSize = sizeof(RadioResponseHeader) + sizeof(RadioResponse2012);
+    } else {
+        header.command.size = sizeof(RadioCommand2014) + sizeof(TransceiverSendNRF24Packet);
+        memcpy(header.address.address, robot2014_address, sizeof(header.address.address));
+        header.address.expectedResponseSize = sizeof(RadioResponseHeader) + sizeof(RadioResponse2014);
     }
+    header.address.address[4] |= id;
+    return header;
 }
 
 void Transceiver::open()
@@ -219,23 +256,56 @@ void Transceiver::close(const QString &errorMsg)
 #endif // USB_FOUND
 }
 
+void Transceiver::beginPacket()
+{
+    m_packetSize = 0;
+}
+
+void Transceiver::appendPacket(const void *data, int size)
+{
+    Q_ASSERT(m_packetSize + size <= PACKET_CAPACITY);
+    memcpy(m_packet + m_packetSize, data, size);
+    m_packetSize += size;
+}
+
+void Transceiver::sendPacket(bool droppable)
+{
+    write(m_packet, m_packetSize, droppable);
+}
+
 void Transceiver::timeout()
 {
     close("Transceiver is not responding");
 }
 
-bool Transceiver::write(const char *data, qint64 size)
+bool Transceiver::write(const char *data, qint64 size, bool droppable)
 {
 #ifdef USB_FOUND
     if (!m_device) {
         return false;
     }
 
+    qint64 written = m_device->write(data, size);
+    // all transfers are in flight, command frames are just dropped as the
+    // next one follows shortly, but control packets must reach the transceiver
+    if (written == 0 && !droppable) {
+        // a failed transfer is reported by the retry
+        m_device->waitForFreeTransfer(CONTROL_WRITE_TIMEOUT);
+        written = m_device->write(data, size);
+        if (written == 0) {
+            close("Transceiver is not accepting packets");
+            return false;
+        }
+    }
+
     // close radio link on errors
-    if (m_device->write(data, size) < 0) {
+    if (written < 0) {
         close();
         return false;
     }
+    if (written == 0) {
+        return false;
+    }
 #endif // USB_FOUND
     return true;
 }
@@ -369,6 +439,17 @@ float Transceiver::calculateDroppedFramesRatio(uint generation, uint id, uint8_t
         c.skipedFrames = skipedFrames;
     }
 
+    // frames without response since the last one
+    int lossRun = 0;
+    if (c.startValue != -1 && counter != c.lastFrameCounter) {
+        lossRun = (counter - c.lastFrameCounter - 1 + 256) % 256;
+    }
+    if (lossRun > 0) {
+        LinkStatistics &s = m_linkStatistics[qMakePair(generation, id)];
+        s.lossRuns[qMin(lossRun, LOSS_RUN_BUCKETS) - 1]++;
+        s.lostFrames += lossRun;
+    }
+
     // correctly handle startup
     if (c.startValue == -1) {
         c.startValue = counter;
@@ -392,6 +473,58 @@ float Transceiver::calculateDroppedFramesRatio(uint generation, uint id, uint8_t
     return c.droppedFramesRatio;
 }
 
+void Transceiver::addResponseLatency(uint generation, uint id, uint8_t counter, qint64 time)
+{
+    LinkStatistics &s = m_linkStatistics[qMakePair(generation, id)];
+    s.responses++;
+    if (m_frameTimes[counter] == 0) {
+        return;
+    }
+
+    const float latency = (time - m_frameTimes[counter]) / 1E9;
+    int bucket = 0;
+    while (bucket < LATENCY_BUCKETS - 1 && latency > LATENCY_LIMITS[bucket]) {
+        bucket++;
+    }
+    s.latency[bucket]++;
+}
+
+void Transceiver::addLinkStatistics(amun::Status *status)
+{
+    if (m_statisticsFrames == 0) {
+        return;
+    }
+
+    amun::StatusRadio *radio = status->mutable_radio();
+    for (int i = 0; i < LATENCY_BUCKETS - 1; i++) {
+        radio->add_latency_bucket(LATENCY_LIMITS[i]);
+    }
+    for (int i = 0; i < USB_QUEUE_BUCKETS; i++) {
+        radio->add_usb_queue_depth(m_usbQueueDepth[i]);
+    }
+    radio->set_frames(m_statisticsFrames);
+
+    for (auto it = m_linkStatistics.constBegin(); it != m_linkStatistics.constEnd(); ++it) {
+        const LinkStatistics &s = it.value();
+        amun::StatusRadioRobot *robot = radio->add_robot();
+        robot->set_generation(it.key().first);
+        robot->set_id(it.key().second);
+        for (int i = 0; i < LATENCY_BUCKETS; i++) {
+            robot->add_latency(s.latency[i]);
+        }
+        for (int i = 0; i < LOSS_RUN_BUCKETS; i++) {
+            robot->add_loss_run(s.lossRuns[i]);
+        }
+        robot->set_responses(s.responses);
+        robot->set_lost_frames(s.lostFrames);
+    }
+
+    // start the next period
+    m_linkStatistics.clear();
+    memset(m_usbQueueDepth, 0, sizeof(m_usbQueueDepth));
+    m_statisticsFrames = 0;
+}
+
 void Transceiver::handleResponsePacket(QList<robot::RadioResponse> &responses, const char *data, uint size, qint64 time)
 {
     const RadioResponseHeader *header = (const RadioResponseHeader *)data;
@@ -409,6 +542,7 @@ void Transceiver::handleResponsePacket(QList<robot::RadioResponse> &responses, c
         r.set_packet_loss_rx(packet->packet_loss / 255.0f);
         float df = calculateDroppedFramesRatio(2, packet->id, packet->counter, 0);
         r.set_packet_loss_tx(df);
+        addResponseLatency(2, packet->id, packet->counter, time);
         if (packet->main_active) {
             robot::SpeedStatus *speedStatus = r.mutable_estimated_speed();
             speedStatus->set_v_f(packet->v_f / 1000.f);
@@ -431,6 +565,7 @@ void Transceiver::handleResponsePacket(QList<robot::RadioResponse> &responses, c
 
         int packet_loss = (packet->extension_id == EXTENSION_BASIC_STATUS) ? packet->packet_loss : -1;
         float df = calculateDroppedFramesRatio(3, packet->id, packet->counter, packet_loss);
+        addResponseLatency(3, packet->id, packet->counter, time);
         switch (packet->extension_id) {
         case EXTENSION_BASIC_STATUS:
             r.set_battery(packet->battery / 255.0f);
@@ -463,14 +598,14 @@ void Transceiver::handleResponsePacket(QList<robot::RadioResponse> &responses, c
             r.set_ball_detected(packet->ball_detected);
             r.set_cap_charged(packet->cap_charged);
         }
-        if (m_frameTimes.contains(packet->counter)) {
+        if (m_frameTimes[packet->counter] != 0) {
             r.set_radio_rtt((time - m_frameTimes[packet->counter]) / 1E9);
         }
         responses.append(r);
     }
 }
 
-void Transceiver::addRobot2012Command(int id, const robot::Command &command, bool charge, quint8 packetCounter, QByteArray &usb_packet)
+void Transceiver::addRobot2012Command(int id, const robot::Command &command, bool charge, quint8 packetCounter)
 {
     // copy command
     RadioCommand2012 data;
@@ -486,21 +621,14 @@ void Transceiver::addRobot2012Command(int id, const robot::Command &command, boo
     data.id = id;
 
     // set address
-    TransceiverCommandPacket senderCommand;
-    senderCommand.command = COMMAND_SEND_NRF24;
-    senderCommand.size = sizeof(data) + sizeof(TransceiverSendNRF24Packet);
+    const QPair<uint, uint> key = qMakePair(2u, (uint)id);
+    const RobotHeader header = m_robotHeaders.contains(key) ? m_robotHeaders.value(key) : robotHeader(2, id);
 
-    TransceiverSendNRF24Packet targetAddress;
-    memcpy(targetAddress.address, robot2012_address, sizeof(targetAddress.address));
-    targetAddress.address[4] |= id;
-    targetAddress.expectedResponseSize = sizeof(RadioResponseHeader) + sizeof(RadioResponse2012);
-
-    usb_packet.append((const char*) &senderCommand, sizeof(senderCommand));
-    usb_packet.append((const char*) &targetAddress, sizeof(targetAddress));
-    usb_packet.append((const char*) &data, sizeof(data));
+    appendPacket(&header, sizeof(header));
+    appendPacket(&data, sizeof(data));
 }
 
-void Transceiver::addRobot2014Command(int id, const robot::Command &command, bool charge, quint8 packetCounter, QByteArray &usb_packet)
+void Transceiver::addRobot2014Command(int id, const robot::Command &command, bool charge, quint8 packetCounter)
 {
     // copy command
     RadioCommand2014 data;
@@ -519,26 +647,19 @@ void Transceiver::addRobot2014Command(int id, const robot::Command &command, boo
     data.omega = qBound<qint32>(-RADIOCOMMAND2014_OMEGA_MAX, command.omega() * 1000.0f, RADIOCOMMAND2014_OMEGA_MAX);
     data.id = id;
     data.force_kick = command.force_kick();
-    data.ir_param = qBound<quint8>(0, m_ir_param[qMakePair(3, id)], 63);
+    data.ir_param = qBound<quint8>(0, m_ir_param.value(qMakePair(3u, (uint)id)), 63);
     data.eject_sdcard = command.eject_sdcard();
     data.unused = 0;
 
     // set address
-    TransceiverCommandPacket senderCommand;
-    senderCommand.command = COMMAND_SEND_NRF24;
-    senderCommand.size = sizeof(data) + sizeof(TransceiverSendNRF24Packet);
+    const QPair<uint, uint> key = qMakePair(3u, (uint)id);
+    const RobotHeader header = m_robotHeaders.contains(key) ? m_robotHeaders.value(key) : robotHeader(3, id);
 
-    TransceiverSendNRF24Packet targetAddress;
-    memcpy(targetAddress.address, robot2014_address, sizeof(targetAddress.address));
-    targetAddress.address[4] |= id;
-    targetAddress.expectedResponseSize = sizeof(RadioResponseHeader) + sizeof(RadioResponse2014);
-
-    usb_packet.append((const char*) &senderCommand, sizeof(senderCommand));
-    usb_packet.append((const char*) &targetAddress, sizeof(targetAddress));
-    usb_packet.append((const char*) &data, sizeof(data));
+    appendPacket(&header, sizeof(header));
+    appendPacket(&data, sizeof(data));
 }
 
-void Transceiver::addPingPacket(qint64 time, QByteArray &usb_packet)
+void Transceiver::addPingPacket(qint64 time)
 {
     // Append ping packet with current timestamp
     TransceiverCommandPacket senderCommand;
@@ -548,18 +669,18 @@ void Transceiver::addPingPacket(qint64 time, QByteArray &usb_packet)
     TransceiverPingData ping;
     ping.time = time;
 
-    usb_packet.append((const char*) &senderCommand, sizeof(senderCommand));
-    usb_packet.append((const char*) &ping, sizeof(ping));
+    appendPacket(&senderCommand, sizeof(senderCommand));
+    appendPacket(&ping, sizeof(ping));
 }
 
-void Transceiver::addStatusPacket(QByteArray &usb_packet)
+void Transceiver::addStatusPacket()
 {
     // request count of dropped usb packets
     TransceiverCommandPacket senderCommand;
     senderCommand.command = COMMAND_STATUS;
     senderCommand.size = 0;
 
-    usb_packet.append((const char*) &senderCommand, sizeof(senderCommand));
+    appendPacket(&senderCommand, sizeof(senderCommand));
 }
 
 void Transceiver::sendCommand(const QList<robot::RadioCommand> &commands, bool charge)
@@ -568,46 +689,46 @@ void Transceiver::sendCommand(const QList<robot::RadioCommand> &commands, bool c
         return;
     }
 
-    typedef QList<robot::RadioCommand> RobotList;
-
-    QMap<uint, RobotList> generations;
-    foreach (const robot::RadioCommand &robot, commands) {
-        // group by generation
-        generations[robot.generation()].append(robot);
-    }
-
     m_packetCounter++;
     // remember when the packetCounter was used
     const qint64 time = Timer::systemTime();
     m_frameTimes[m_packetCounter] = time;
 
-    // used for packet assembly
-    QByteArray usb_packet;
-
-    QMapIterator<uint, RobotList> it(generations);
-    while (it.hasNext()) {
-        it.next();
+    // leave space for the ping and status packets
+    const int robotPacketSize = sizeof(RobotHeader) + qMax(sizeof(RadioCommand2012), sizeof(RadioCommand2014));
+    const int maxSize = PACKET_CAPACITY - 2 * (sizeof(TransceiverCommandPacket) + sizeof(TransceiverPingData))
+            - sizeof(TransceiverCommandPacket) - robotPacketSize;
 
-        foreach (const robot::RadioCommand &radio_command, it.value()) {
-            if (it.key() == 2) {
-                addRobot2012Command(radio_command.id(), radio_command.command(), charge, m_packetCounter, usb_packet);
-            } else if (it.key() == 3) {
-                addRobot2014Command(radio_command.id(), radio_command.command(), charge, m_packetCounter, usb_packet);
-            }
+    beginPacket();
+    // commands are grouped by generation
+    foreach (const robot::RadioCommand &radio_command, commands) {
+        if (radio_command.generation() == 2 && m_packetSize <= maxSize) {
+            addRobot2012Command(radio_command.id(), radio_command.command(), charge, m_packetCounter);
+        }
+    }
+    foreach (const robot::RadioCommand &radio_command, commands) {
+        if (radio_command.generation() == 3 && m_packetSize <= maxSize) {
+            addRobot2014Command(radio_command.id(), radio_command.command(), charge, m_packetCounter);
         }
     }
 
-    addPingPacket(time, usb_packet);
+    addPingPacket(time);
     if (m_packetCounter == 255) {
-        addStatusPacket(usb_packet);
+        addStatusPacket();
     }
 
     // Workaround for usb problems if packet size is a multiple of transfer size
-    if (usb_packet.size() % 64 == 0) {
-        addPingPacket(time, usb_packet);
+    if (m_packetSize % 64 == 0) {
+        addPingPacket(time);
     }
 
-    write(usb_packet.data(), usb_packet.size());
+#ifdef USB_FOUND
+    // transfers of previous frames which are still in flight
+    m_usbQueueDepth[qMin(m_device->pendingWrites(), USB_QUEUE_BUCKETS - 1)]++;
+#endif // USB_FOUND
+    m_statisticsFrames++;
+
+    sendPacket(true);
 
     // only restart timeout if not yet active
     if (!m_timeoutTimer->isActive()) {
@@ -637,11 +758,11 @@ void Transceiver::sendParameters(const robot::RadioParameters &parameters)
     memcpy(targetAddress.address, robot2012_config_broadcast, sizeof(targetAddress.address));
     targetAddress.expectedResponseSize = 0;
 
-    QByteArray usb_packet;
-    usb_packet.append((const char *) &senderCommand, sizeof(senderCommand));
-    usb_packet.append((const char *) &targetAddress, sizeof(targetAddress));
-    usb_packet.append((const char *) &p, senderCommand.size);
-    write(usb_packet.data(), usb_packet.size());
+    beginPacket();
+    appendPacket(&senderCommand, sizeof(senderCommand));
+    appendPacket(&targetAddress, sizeof(targetAddress));
+    appendPacket(&p, sizeof(p));
+    sendPacket();
 }
 
 void Transceiver::sendTransceiverConfiguration()
@@ -654,10 +775,10 @@ void Transceiver::sendTransceiverConfiguration()
     TransceiverSetFrequencyPacket config;
     config.channel = m_configuration.channel();
 
-    QByteArray usb_packet;
-    usb_packet.append((const char *) &senderCommand, sizeof(senderCommand));
-    usb_packet.append((const char *) &config, sizeof(config));
-    write(usb_packet.data(), usb_packet.size());
+    beginPacket();
+    appendPacket(&senderCommand, sizeof(senderCommand));
+    appendPacket(&config, sizeof(config));
+    sendPacket();
 }
 
 void Transceiver::sendInitPacket()
@@ -670,8 +791,8 @@ void Transceiver::sendInitPacket()
     TransceiverInitPacket config;
     config.protocolVersion = PROTOCOL_VERSION;
 
-    QByteArray usb_packet;
-    usb_packet.append((const char *) &senderCommand, sizeof(senderCommand));
-    usb_packet.append((const char *) &config, sizeof(config));
-    write(usb_packet.data(), usb_packet.size());
+    beginPacket();
+    appendPacket(&senderCommand, sizeof(senderCommand));
+    appendPacket(&config, sizeof(config));
+    sendPacket();
 }
@@ -23,9 +23,11 @@
 
 #include "protobuf/command.h"
 #include "protobuf/status.h"
+#include "firmware/2012/common/transceiver2012.h"
 
 #include <QMap>
 #include <QPair>
+#include <algorithm>
 
 class QTimer;
 class USBThread;
@@ -46,6 +48,29 @@ private:
         DroppedFrameCounter() : startValue(-1), lastFrameCounter(0), droppedFramesCounter(0), droppedFramesRatio(0), skipedFrames(0) {}
     };
 
+    static const int LATENCY_BUCKETS = 10;
+    static const int LOSS_RUN_BUCKETS = 8;
+    static const int USB_QUEUE_BUCKETS = 5;
+
+    struct LinkStatistics {
+        quint32 latency[LATENCY_BUCKETS];
+        quint32 lossRuns[LOSS_RUN_BUCKETS];
+        quint32 responses;
+        quint32 lostFrames;
+
+        LinkStatistics() : responses(0), lostFrames(0)
+        {
+            std::fill(latency, latency + LATENCY_BUCKETS, 0);
+            std::fill(lossRuns, lossRuns + LOSS_RUN_BUCKETS, 0);
+        }
+    };
+
+    // transceiver command and address of a robot, prepended to each radio command
+    struct RobotHeader {
+        TransceiverCommandPacket command;
+        TransceiverSendNRF24Packet address;
+    } __attribute__ ((packed));
+
     enum class State {
         DISCONNECTED,
         HANDSHAKE,
@@ -72,22 +97,30 @@ private:
     void open();
     bool ensureOpen();
     void close(const QString &errorMsg = QString());
-    bool write(const char *data, qint64 size);
+    bool write(const char *data, qint64 size, bool droppable);
 
     void handleInitPacket(const char *data, uint size);
     void handlePingPacket(const char *data, uint size);
     void handleStatusPacket(const char *data, uint size);
     void handleDatagramPacket(const char *data, uint size);
     float calculateDroppedFramesRatio(uint generation, uint id, uint8_t counter, int skipedFrames);
+    void addResponseLatency(uint generation, uint id, uint8_t counter, qint64 time);
+    void addLinkStatistics(amun::Status *status);
     void handleResponsePacket(QList<robot::RadioResponse> &response, const char *data, uint size, qint64 time);
     void handleTeam(const robot::Team &team);
 
+    static RobotHeader robotHeader(uint generation, uint id);
+
+    void beginPacket();
+    void appendPacket(const void *data, int size);
+    void sendPacket(bool droppable = false);
+
     void sendInitPacket();
     void sendTransceiverConfiguration();
-    void addRobot2012Command(int id, const robot::Command &command, bool charge, quint8 packetCounter, QByteArray &usb_packet);
-    void addRobot2014Command(int id, const robot::Command &command, bool charge, quint8 packetCounter, QByteArray &usb_packet);
-    void addPingPacket(qint64 time, QByteArray &usb_packet);
-    void addStatusPacket(QByteArray &usb_packet);
+    void addRobot2012Command(int id, const robot::Command &command, bool charge, quint8 packetCounter);
+    void addRobot2014Command(int id, const robot::Command &command, bool charge, quint8 packetCounter);
+    void addPingPacket(qint64 time);
+    void addStatusPacket();
     void sendCommand(const QList<robot::RadioCommand> &commands, bool charge);
     void sendParameters(const robot::RadioParameters &parameters);
 
@@ -95,8 +128,21 @@ private:
     bool m_charge;
     amun::TransceiverConfiguration m_configuration;
     QMap<QPair<uint, uint>, DroppedFrameCounter> m_droppedFrames;
+    QMap<QPair<uint, uint>, LinkStatistics> m_linkStatistics;
+    quint32 m_usbQueueDepth[USB_QUEUE_BUCKETS];
+    quint32 m_statisticsFrames;
+    qint64 m_statisticsStart;
     QMap<QPair<uint, uint>, uint> m_ir_param;
-    QMap<quint8, qint64> m_frameTimes;
+    QMap<QPair<uint, uint>, RobotHeader> m_robotHeaders;
+    // send time for each packet counter value, 0 if not used yet
+    qint64 m_frameTimes[256];
+
+    // used for packet assembly, matches the maximum usb transfer size
+    static const int PACKET_CAPACITY = 1024;
+    // maximum time to wait for a free usb transfer for control packets in ms
+    static const int CONTROL_WRITE_TIMEOUT = 100;
+    char m_packet[PACKET_CAPACITY];
+    int m_packetSize;
 
     quint8 m_packetCounter;
     USBThread *m_context;
@@ -36,13 +36,6 @@ struct USBDevicePrivateData
     libusb_device_descriptor descriptor;
 };
 
-struct USBResult
-{
-    QSemaphore sem;
-    libusb_transfer_status status;
-    int bytesTransfered;
-};
-
 QList<USBDevice*> USBDevice::getDevices(quint16 vendorId, quint16 productId, USBThread *context)
 {
     QList<USBDevice*> devices;
@@ -74,8 +67,16 @@ USBDevice::USBDevice(void *device) :
     m_mutex(QMutex::Recursive),
     m_inboundTransfer(NULL),
     m_shutingDown(false),
-    m_readError(false)
+    m_readError(false),
+    m_writeError(false),
+    m_readErrorCode(0),
+    m_writeErrorCode(0)
 {
+    for (int i = 0; i < OUT_TRANSFER_COUNT; i++) {
+        m_outboundTransfers[i] = NULL;
+        m_outboundPending[i] = false;
+    }
+
     m_data = new USBDevicePrivateData;
     m_data->device = (libusb_device*) device;
     m_data->handle = NULL;
@@ -181,6 +182,17 @@ bool USBDevice::open(OpenMode)
     }
     m_id = QString::fromUtf16((const ushort *) &c[2], (qMin<int>(ret, c[0]) - 2) / 2);
 
+    // allocate the outbound transfers once, writes only have to submit them
+    for (int i = 0; i < OUT_TRANSFER_COUNT; i++) {
+        m_outboundTransfers[i] = libusb_alloc_transfer(0);
+        if (m_outboundTransfers[i] == NULL) {
+            setErrorString(LIBUSB_ERROR_NO_MEM);
+            close();
+            return false;
+        }
+    }
+    m_freeTransfers.release(OUT_TRANSFER_COUNT);
+
     // create transfer for receiving robot status
     startInTransfer();
     return QIODevice::open(ReadWrite | Unbuffered);
@@ -190,7 +202,7 @@ void USBDevice::close()
 {
     QIODevice::close();
     if (m_data->handle) {
-        bool waitForCancelation = false;
+        int waitForCancelation = 0;
         {
             QMutexLocker m(&m_mutex);
             // prevent starting a new transfer
@@ -199,13 +211,24 @@ void USBDevice::close()
                 // here either a transfer is pending, or the callback didn't reach its lock yet
                 libusb_cancel_transfer(m_inboundTransfer);
                 // wait until transfer is cancelled
-                waitForCancelation = true;
+                waitForCancelation++;
                 m_inboundTransfer = nullptr;
             }
+            for (int i = 0; i < OUT_TRANSFER_COUNT; i++) {
+                if (m_outboundPending[i]) {
+                    libusb_cancel_transfer(m_outboundTransfers[i]);
+                    waitForCancelation++;
+                }
+            }
         }
-        if (waitForCancelation) {
-            m_shutdownSemaphore.acquire();
+        m_shutdownSemaphore.acquire(waitForCancelation);
+        for (int i = 0; i < OUT_TRANSFER_COUNT; i++) {
+            libusb_free_transfer(m_outboundTransfers[i]);
+            m_outboundTransfers[i] = NULL;
+            m_outboundPending[i] = false;
         }
+        // all callbacks have finished, no transfer can be released anymore
+        m_freeTransfers.acquire(m_freeTransfers.available());
         libusb_release_interface(m_data->handle, 0);
         libusb_close(m_data->handle);
         m_data->handle = NULL;
@@ -222,6 +245,28 @@ void USBDevice::setTimeout(int timeout)
     m_timeout = timeout;
 }
 
+// waits until an outbound transfer has completed, returns false on timeout or error
+bool USBDevice::waitForFreeTransfer(int msecs)
+{
+    if (!m_freeTransfers.tryAcquire(1, msecs)) {
+        return false;
+    }
+    m_freeTransfers.release();
+    return !m_writeError;
+}
+
+int USBDevice::pendingWrites()
+{
+    QMutexLocker m(&m_mutex);
+    int count = 0;
+    for (int i = 0; i < OUT_TRANSFER_COUNT; i++) {
+        if (m_outboundPending[i]) {
+            count++;
+        }
+    }
+    return count;
+}
+
 QString USBDevice::vendorIdString() const
 {
     return QString("0x%1").arg(vendorId(), 4, 16, QChar('0'));
@@ -268,8 +313,8 @@ void USBDevice::inCallback(libusb_transfer *transfer)
         // reschedule transfer
         startInTransfer();
     } else {
-        // error
-        setErrorString(transfer->status);
+        // error, reported by the next read
+        m_readErrorCode = transfer->status;
         m_readError = true;
     }
 }
@@ -287,7 +332,7 @@ void USBDevice::startInTransfer()
     // create transfer for receiving inbound transmissions
     m_inboundTransfer = libusb_alloc_transfer(0);
     if (m_inboundTransfer == NULL) {
-        setErrorString(LIBUSB_ERROR_NO_MEM);
+        m_readErrorCode = LIBUSB_ERROR_NO_MEM;
         m_readError = true;
         return;
     }
@@ -295,7 +340,7 @@ void USBDevice::startInTransfer()
     int ret = libusb_submit_transfer(m_inboundTransfer);
     if (ret < 0) {
         // error
-        setErrorString(ret);
+        m_readErrorCode = ret;
         libusb_free_transfer(m_inboundTransfer);
         m_inboundTransfer = NULL;
         m_readError = true;
@@ -304,7 +349,12 @@ void USBDevice::startInTransfer()
 
 qint64 USBDevice::readData(char* data, qint64 maxSize)
 {
-    if (!m_data->handle || m_readError.load()) {
+    if (m_readError) {
+        QMutexLocker m(&m_mutex);
+        setErrorString(m_readErrorCode);
+        return -1;
+    }
+    if (!m_data->handle) {
         return -1;
     }
 
@@ -321,54 +371,80 @@ qint64 USBDevice::readData(char* data, qint64 maxSize)
     return l;
 }
 
-// called from usb thread
 LIBUSB_CALL void outCallback(libusb_transfer* transfer)
 {
-    USBResult *result = reinterpret_cast<USBResult*>(transfer->user_data);
+    USBDevice *device = reinterpret_cast<USBDevice*>(transfer->user_data);
+    device->outCallback(transfer);
+}
 
-    if (transfer->status == LIBUSB_TRANSFER_COMPLETED) {
-        result->bytesTransfered = transfer->actual_length;
-    } else {
-        result->bytesTransfered = -1;
+// called from usb thread
+void USBDevice::outCallback(libusb_transfer *transfer)
+{
+    QMutexLocker m(&m_mutex);
+    // the transfer can be reused
+    for (int i = 0; i < OUT_TRANSFER_COUNT; i++) {
+        if (m_outboundTransfers[i] == transfer && m_outboundPending[i]) {
+            m_outboundPending[i] = false;
+            m_freeTransfers.release();
+        }
     }
 
-    result->status = transfer->status;
-    result->sem.release();
-    libusb_free_transfer(transfer);
+    if (m_shutingDown) {
+        m_shutdownSemaphore.release();
+        return;
+    }
+
+    if (transfer->status != LIBUSB_TRANSFER_COMPLETED) {
+        // report the error on the next write
+        m_writeErrorCode = transfer->status;
+        m_writeError = true;
+    }
 }
 
+// doesn't wait for the transfer to complete, errors are reported by the following write
 qint64 USBDevice::writeData(const char* data, qint64 maxSize)
 {
-    if (!m_data->handle || m_readError) {
+    if (m_readError || m_writeError) {
+        QMutexLocker m(&m_mutex);
+        setErrorString(m_writeError ? m_writeErrorCode : m_readErrorCode);
+        return -1;
+    }
+    if (!m_data->handle) {
         return -1;
     }
 
-    // send data
-    libusb_transfer *outTransfer = libusb_alloc_transfer(0);
-    if (outTransfer == NULL) {
-        setErrorString(LIBUSB_ERROR_NO_MEM);
+    if (maxSize > OUT_TRANSFER_SIZE) {
+        setErrorString(LIBUSB_ERROR_OVERFLOW);
         return -1;
     }
-    USBResult *result = new USBResult();
 
+    QMutexLocker m(&m_mutex);
+    int index = -1;
+    for (int i = 0; i < OUT_TRANSFER_COUNT; i++) {
+        if (!m_outboundPending[i]) {
+            index = i;
+            break;
+        }
+    }
+    if (index == -1) {
+        // the device doesn't keep up, the caller decides whether to drop the packet
+        return 0;
+    }
+    // can't block as the transfer isn't pending
+    m_freeTransfers.acquire();
+
+    memcpy(m_outboundBuffers[index], data, maxSize);
+    libusb_transfer *outTransfer = m_outboundTransfers[index];
     libusb_fill_bulk_transfer(outTransfer, m_data->handle, LIBUSB_ENDPOINT_OUT | 0x01,
-                              reinterpret_cast<unsigned char*>(const_cast<char*>(data)), maxSize,
-                              ::outCallback, result, m_timeout);
+                              m_outboundBuffers[index], maxSize, ::outCallback, this, m_timeout);
     int ret = libusb_submit_transfer(outTransfer);
     if (ret < 0) {
         // error
+        m_freeTransfers.release();
         setErrorString(ret);
-        libusb_free_transfer(outTransfer);
         return -1;
     }
 
-    result->sem.acquire(1);
-    int bytesTransfered = result->bytesTransfered;
-
-    if (result->bytesTransfered < 0) {
-        setErrorString(result->status);
-    }
-
-    delete result;
-    return bytesTransfered;
+    m_outboundPending[index] = true;
+    return maxSize;
 }
@@ -47,6 +47,8 @@ public:
     void close() override;
     bool isSequential() const override;
     void setTimeout(int timeout);
+    int pendingWrites();
+    bool waitForFreeTransfer(int msecs);
 
 public:
     QString vendorIdString() const;
@@ -58,6 +60,7 @@ public:
 
 public:
     void inCallback(libusb_transfer *transfer);
+    void outCallback(libusb_transfer *transfer);
 
 protected:
     void startInTransfer();
@@ -68,6 +71,11 @@ protected:
     static QString getErrorString(int error);
 
 private:
+    // number of outbound transfers that may be in flight at once
+    static const int OUT_TRANSFER_COUNT = 4;
+    // maximum size of a single write
+    static const int OUT_TRANSFER_SIZE = 1024;
+
     USBDevicePrivateData* m_data;
     int m_timeout;
     quint8 m_buffer[512];
@@ -75,11 +83,21 @@ private:
 
     QMutex m_mutex;
     libusb_transfer *m_inboundTransfer;
+    libusb_transfer *m_outboundTransfers[OUT_TRANSFER_COUNT];
+    bool m_outboundPending[OUT_TRANSFER_COUNT];
+    quint8 m_outboundBuffers[OUT_TRANSFER_COUNT][OUT_TRANSFER_SIZE];
 
+    // counts the outbound transfers which are not in flight
+    QSemaphore m_freeTransfers;
     QSemaphore m_shutdownSemaphore;
     bool m_shutingDown;
 
+    // errors from the usb thread are only recorded there, the error string
+    // is set by the next read or write on the owning thread
     std::atomic_bool m_readError;
+    std::atomic_bool m_writeError;
+    int m_readErrorCode;
+    int m_writeErrorCode;
     QString m_serialNumber;
     QString m_id;
 };
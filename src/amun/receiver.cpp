@@ -21,23 +21,49 @@
 #include "receiver.h"
 #include "core/timer.h"
 #include <QNetworkInterface>
+#include <QSocketNotifier>
 #include <QUdpSocket>
 #include <QTimer>
 
+#ifdef Q_OS_LINUX
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+
+// maximum number of datagrams read by a single call to recvmmsg
+static const int BATCH_SIZE = 8;
+// vision geometry packets are the largest ssl datagrams with a few KiB,
+// larger datagrams are truncated and dropped
+static const int MAX_DATAGRAM_SIZE = 16384;
+
+//! Preallocated buffers for recvmmsg, reused for every read
+struct Receiver::BatchBuffers
+{
+    mmsghdr messages[BATCH_SIZE];
+    iovec vectors[BATCH_SIZE];
+    char control[BATCH_SIZE][CMSG_SPACE(sizeof(timespec))];
+    // datagrams are received directly into the emitted byte arrays
+    QByteArray data[BATCH_SIZE];
+};
+#endif // Q_OS_LINUX
+
 /*!
  * \class Receiver
  * \ingroup amun
  * \brief UDP multicast receiver
  *
  * This class is designed to timestamp an incoming packet as early as possible
- * by being moved to a dedicated worker thread.
+ * by being moved to a dedicated worker thread. On linux all pending datagrams
+ * are read with a single recvmmsg call and stamped by the kernel on arrival.
  */
 
 /*!
- * \fn void Receiver::gotPacket(QByteArray data, qint64 time)
- * \brief This signal is emitted whenever a new packet has been received
- * \param data  The received packet
- * \param time  Timestamp at which the packet has been received
+ * \fn void Receiver::gotPackets(const QList<QByteArray> &data, const QList<qint64> &times)
+ * \brief This signal is emitted with all packets which were received since the last read
+ * \param data  The received packets, in order of arrival
+ * \param times Timestamp at which each packet has been received
  */
 
 /*!
@@ -48,7 +74,10 @@
 Receiver::Receiver(const QHostAddress &groupAddress, quint16 port) :
     m_groupAddress(groupAddress),
     m_port(port),
-    m_socket(NULL)
+    m_socket(NULL),
+    m_fd(-1),
+    m_notifier(NULL),
+    m_buffers(NULL)
 {
     m_timeoutTimer = new QTimer(this);
     // seems like Qt 5.4.2, 5.5.0 may get stuck from time to time
@@ -62,6 +91,9 @@ Receiver::Receiver(const QHostAddress &groupAddress, quint16 port) :
 Receiver::~Receiver()
 {
     stopListen();
+#ifdef Q_OS_LINUX
+    delete m_buffers;
+#endif
 }
 
 /*!
@@ -71,15 +103,18 @@ void Receiver::startListen()
 {
     stopListen();
 
+#ifdef Q_OS_LINUX
+    if (startNativeListen()) {
+        return;
+    }
+#endif
+
     m_socket = new QUdpSocket(this);
     connect(m_socket, SIGNAL(readyRead()), SLOT(readData()));
     m_socket->bind(QHostAddress::AnyIPv4, m_port, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint);
 
     if (m_socket->state() != QAbstractSocket::BoundState) {
-        // if the socket can't be bound, its probably cause by ssl vision
-        Status status(new amun::Status);
-        status->mutable_amun_state()->mutable_port_bind_error()->set_port(m_port);
-        emit sendStatus(status);
+        sendPortBindError();
         return;
     }
 
@@ -99,15 +134,103 @@ void Receiver::stopListen()
 {
     delete m_socket;
     m_socket = NULL;
+    delete m_notifier;
+    m_notifier = NULL;
+#ifdef Q_OS_LINUX
+    if (m_fd != -1) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+#endif
     m_timeoutTimer->stop();
 }
 
+void Receiver::sendPortBindError()
+{
+    // if the socket can't be bound, its probably cause by ssl vision
+    Status status(new amun::Status);
+    status->mutable_amun_state()->mutable_port_bind_error()->set_port(m_port);
+    emit sendStatus(status);
+}
+
+/*!
+ * \brief Open a native socket to read with recvmmsg
+ * \return false if the native socket is not available, the caller has to fall back to QUdpSocket
+ */
+bool Receiver::startNativeListen()
+{
+#ifdef Q_OS_LINUX
+    const int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        return false;
+    }
+
+    // same as QUdpSocket::ShareAddress, also request kernel receive timestamps
+    const int one = 1;
+    if (::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) == -1
+            || ::setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &one, sizeof(one)) == -1) {
+        ::close(fd);
+        return false;
+    }
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(m_port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (::bind(fd, (const sockaddr *) &address, sizeof(address)) == -1) {
+        ::close(fd);
+        sendPortBindError();
+        return true;
+    }
+
+    if (m_buffers == NULL) {
+        m_buffers = new BatchBuffers;
+    }
+    m_fd = fd;
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, SIGNAL(activated(int)), SLOT(readData()));
+
+    if (!m_groupAddress.isNull()) {
+        foreach (const QNetworkInterface& iface, QNetworkInterface::allInterfaces()) {
+            joinNativeGroup(iface);
+        }
+
+        m_timeoutTimer->start(50);
+    }
+    return true;
+#else
+    return false;
+#endif // Q_OS_LINUX
+}
+
+void Receiver::joinNativeGroup(const QNetworkInterface &interface)
+{
+#ifdef Q_OS_LINUX
+    ip_mreqn request;
+    memset(&request, 0, sizeof(request));
+    request.imr_multiaddr.s_addr = htonl(m_groupAddress.toIPv4Address());
+    request.imr_address.s_addr = htonl(INADDR_ANY);
+    request.imr_ifindex = interface.index();
+    // fails for interfaces without multicast support, just like joinMulticastGroup
+    ::setsockopt(m_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &request, sizeof(request));
+#else
+    Q_UNUSED(interface);
+#endif // Q_OS_LINUX
+}
+
 /*!
  * \brief Join multicast group for this interface, as it has changed
  * \param interface the interface for which the change occured
  */
 void Receiver::updateInterface(const QNetworkInterface& interface)
 {
+    if (m_fd != -1) {
+        if (!m_groupAddress.isNull()) {
+            joinNativeGroup(interface);
+        }
+        return;
+    }
     if (m_socket == nullptr) {
         return;
     }
@@ -134,17 +257,102 @@ void Receiver::updatePort(quint16 port)
 }
 
 /*!
- * \brief Read a packet from the socket and emit \ref gotPacket
+ * \brief Read all pending packets from the socket and emit \ref gotPackets
  */
 void Receiver::readData()
 {
+    if (m_fd != -1) {
+        readNative();
+        return;
+    }
+
+    if (m_socket == NULL) {
+        return;
+    }
+
+    QList<QByteArray> packets;
+    QList<qint64> times;
     while (m_socket->hasPendingDatagrams()) {
         QByteArray data;
         data.resize(m_socket->pendingDatagramSize());
         m_socket->readDatagram(data.data(), data.size());
-        emit gotPacket(data, Timer::systemTime());
+        packets.append(data);
+        times.append(Timer::systemTime());
+    }
+
+    if (!packets.isEmpty()) {
+        emit gotPackets(packets, times);
+        if (!m_groupAddress.isNull()) {
+            m_timeoutTimer->start();
+        }
+    }
+}
+
+void Receiver::readNative()
+{
+#ifdef Q_OS_LINUX
+    QList<QByteArray> packets;
+    QList<qint64> times;
+
+    int count;
+    do {
+        for (int i = 0; i < BATCH_SIZE; i++) {
+            QByteArray &buffer = m_buffers->data[i];
+            if (buffer.isDetached()) {
+                // the previous datagram was released, the capacity is reserved
+                buffer.resize(MAX_DATAGRAM_SIZE);
+            } else {
+                // the previous datagram is still in use, only allocate in that case
+                buffer = QByteArray();
+                buffer.reserve(MAX_DATAGRAM_SIZE);
+                buffer.resize(MAX_DATAGRAM_SIZE);
+            }
+            m_buffers->vectors[i].iov_base = buffer.data();
+            m_buffers->vectors[i].iov_len = MAX_DATAGRAM_SIZE;
+            msghdr &header = m_buffers->messages[i].msg_hdr;
+            memset(&header, 0, sizeof(header));
+            header.msg_iov = &m_buffers->vectors[i];
+            header.msg_iovlen = 1;
+            header.msg_control = m_buffers->control[i];
+            header.msg_controllen = sizeof(m_buffers->control[i]);
+        }
+
+        count = ::recvmmsg(m_fd, m_buffers->messages, BATCH_SIZE, MSG_DONTWAIT, NULL);
+        if (count <= 0) {
+            // nothing left to read
+            break;
+        }
+
+        // fallback if the kernel didn't provide a timestamp
+        const qint64 readTime = Timer::systemTime();
+        for (int i = 0; i < count; i++) {
+            msghdr &header = m_buffers->messages[i].msg_hdr;
+            if (header.msg_flags & MSG_TRUNC) {
+                // can't be parsed anyway
+                continue;
+            }
+            qint64 time = readTime;
+            for (cmsghdr *c = CMSG_FIRSTHDR(&header); c != NULL; c = CMSG_NXTHDR(&header, c)) {
+                if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS) {
+                    // uses CLOCK_REALTIME just like Timer::systemTime
+                    timespec ts;
+                    memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+                    time = qint64(ts.tv_sec) * 1000000000LL + qint64(ts.tv_nsec);
+                }
+            }
+            // shrinking keeps the reserved capacity, the datagram is shared without copying
+            QByteArray &buffer = m_buffers->data[i];
+            buffer.resize(m_buffers->messages[i].msg_len);
+            packets.append(buffer);
+            times.append(time);
+        }
+    } while (count == BATCH_SIZE);
+
+    if (!packets.isEmpty()) {
+        emit gotPackets(packets, times);
         if (!m_groupAddress.isNull()) {
             m_timeoutTimer->start();
         }
     }
+#endif // Q_OS_LINUX
 }
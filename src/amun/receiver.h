@@ -24,6 +24,7 @@
 #include <QUdpSocket>
 #include "protobuf/status.h"
 
+class QSocketNotifier;
 class QTimer;
 
 class Receiver : public QObject
@@ -35,7 +36,7 @@ public:
     ~Receiver() override;
 
 signals:
-    void gotPacket(const QByteArray &data, qint64 time);
+    void gotPackets(const QList<QByteArray> &data, const QList<qint64> &times);
     void sendStatus(const Status &status);
 
 public slots:
@@ -48,10 +49,22 @@ private slots:
     void readData();
 
 private:
+    void sendPortBindError();
+    bool startNativeListen();
+    void joinNativeGroup(const QNetworkInterface &interface);
+    void readNative();
+
+private:
+    struct BatchBuffers;
+
     QHostAddress m_groupAddress;
     quint16 m_port;
     QUdpSocket *m_socket;
     QTimer *m_timeoutTimer;
+    // native socket, only used on linux
+    int m_fd;
+    QSocketNotifier *m_notifier;
+    BatchBuffers *m_buffers;
 };
 
 #endif // RECEIVER_H
@@ -24,11 +24,9 @@
 #include "protobuf/ssl_detection.pb.h"
 #include <cmath>
 
-SimBall::SimBall(RNG *rng, btDiscreteDynamicsWorld *world, float fieldWidth, float fieldHeight) :
+SimBall::SimBall(RNG *rng, btDiscreteDynamicsWorld *world) :
     m_rng(rng),
-    m_world(world),
-    m_fieldWidth(fieldWidth),
-    m_fieldHeight(fieldHeight)
+    m_world(world)
 {
     // see http://robocup.mi.fu-berlin.de/buch/rolling.pdf for correct modelling
     m_sphere = new btSphereShape(BALL_RADIUS * SIMULATOR_SCALE);
@@ -64,7 +62,7 @@ SimBall::~SimBall()
     delete m_motionState;
 }
 
-void SimBall::begin()
+void SimBall::begin(double time)
 {
     // custom implementation of rolling friction
     const btVector3 p = m_body->getWorldTransform().getOrigin() / SIMULATOR_SCALE;
@@ -82,7 +80,7 @@ void SimBall::begin()
             const btScalar rollingDeceleration = hackFactor * 0.35;
             btVector3 force(velocity.x(), velocity.y(), 0.0f);
             force.normalize();
-            m_body->applyCentralImpulse(-force * rollingDeceleration * SIMULATOR_SCALE * BALL_MASS * SUB_TIMESTEP);
+            m_body->applyCentralImpulse(-force * rollingDeceleration * SIMULATOR_SCALE * BALL_MASS * time);
         }
     }
 
@@ -115,14 +113,7 @@ void SimBall::begin()
     }
 }
 
-float sign(float a)
-{
-    return (a >= 0) ? 1 : -1;
-}
-
-// #include <QDebug>
-
-int SimBall::update(SSL_DetectionBall *ball, float stddev)
+bool SimBall::update(SSL_DetectionBall *ball, float stddev, const SimCamera &camera)
 {
     // setup ssl-vision ball detection
     ball->set_confidence(1.0);
@@ -133,41 +124,24 @@ int SimBall::update(SSL_DetectionBall *ball, float stddev)
     m_motionState->getWorldTransform(transform);
     const btVector3 p = transform.getOrigin() / SIMULATOR_SCALE;
 
-    // must match simulator camera geometry!!!
-    const float cameraHeight = 4.f;
-    const float cameraX = m_fieldWidth / 4;
-    const float cameraY = m_fieldHeight / 4;
-    const float maxOverlap = 0.4f;
-
+    // project the ball onto the field as seen from the camera
     const float scalingLimit = 0.9f;
-    const float widthHalf = cameraX * 2.7f;
-    const float heightHalf = cameraY * 2.7f;
-    int cameraId = ((p.x() > 0) ? 1 : 0) + ((p.y() > 0) ? 2 : 0);
-
-    float height = std::min(scalingLimit * cameraHeight, std::max(0.f, p.z() - BALL_RADIUS));
-    float abs_x = std::abs(p.x());
-    float abs_y = std::abs(p.y());
-    abs_x = (abs_x - cameraX) * (cameraHeight / (cameraHeight - height)) + cameraX;
-    abs_y = (abs_y - cameraY) * (cameraHeight / (cameraHeight - height)) + cameraY;
-
-    if (abs_x < -maxOverlap || abs_x > widthHalf || abs_y < -maxOverlap || abs_y > heightHalf) {
-        // invalid
-        return -1;
+    const float height = std::min(scalingLimit * camera.height, std::max(0.f, p.z() - BALL_RADIUS));
+    const float scaling = camera.height / (camera.height - height);
+    const float ball_x = (p.x() - camera.x) * scaling + camera.x;
+    const float ball_y = (p.y() - camera.y) * scaling + camera.y;
+
+    if (ball_x < camera.minX || ball_x > camera.maxX || ball_y < camera.minY || ball_y > camera.maxY) {
+        // not visible for this camera
+        return false;
     }
 
-    const float ball_x = sign(p.x()) * abs_x;
-    const float ball_y = sign(p.y()) * abs_y;
-
-    // if (height > 0.1f) {
-    //     qDebug() << "simball" << p.x() << p.y() << height << "ttt" << ball_x << ball_y;
-    // }
-
     // add noise to coordinates
     // to convert from bullet coordinate system to ssl-vision rotate by 90 degree ccw
     const Vector2 noise = m_rng->normalVector(stddev);
     ball->set_x((ball_y + noise.x) * 1000.0f);
     ball->set_y(-(ball_x + noise.y) * 1000.0f);
-    return cameraId;
+    return true;
 }
 
 void SimBall::move(const amun::SimulatorMoveBall &ball)
@@ -175,6 +149,12 @@ void SimBall::move(const amun::SimulatorMoveBall &ball)
     m_move = ball;
 }
 
+btVector3 SimBall::realPosition() const
+{
+    const btTransform transform = m_body->getWorldTransform();
+    return transform.getOrigin() / SIMULATOR_SCALE;
+}
+
 btVector3 SimBall::position() const
 {
     const btTransform transform = m_body->getWorldTransform();
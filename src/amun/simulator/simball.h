@@ -30,19 +30,21 @@ static const float BALL_DECELERATION = 0.5f;
 
 class RNG;
 class SSL_DetectionBall;
+struct SimCamera;
 
 class SimBall
 {
 public:
-    SimBall(RNG *rng, btDiscreteDynamicsWorld *world, float fieldWidth, float fieldHeight);
+    SimBall(RNG *rng, btDiscreteDynamicsWorld *world);
     ~SimBall();
 
 public:
-    void begin();
-    int update(SSL_DetectionBall *ball, float stddev);
+    void begin(double time);
+    bool update(SSL_DetectionBall *ball, float stddev, const SimCamera &camera);
     void move(const amun::SimulatorMoveBall &ball);
     void kick(const btVector3 &power);
     btVector3 position() const;
+    btVector3 realPosition() const;
     btVector3 speed() const;
     const btRigidBody *body() const { return m_body; }
 
@@ -53,8 +55,6 @@ private:
     btRigidBody *m_body;
     btMotionState *m_motionState;
     amun::SimulatorMoveBall m_move;
-    const float m_fieldWidth;
-    const float m_fieldHeight;
 };
 
 #endif // SIMBALL_H
@@ -257,6 +257,12 @@ btVector3 SimRobot::relativeBallSpeed(SimBall *ball) const
     return diff;
 }
 
+bool SimRobot::isKickArmed() const
+{
+    // the robot will kick as soon as it touches the ball
+    return m_isCharged && m_command.has_kick_power() && m_command.kick_power() > 0;
+}
+
 bool SimRobot::canKickBall(SimBall *ball) const
 {
     bool ballCollidesWithRobot = false;
@@ -336,6 +342,13 @@ robot::RadioResponse SimRobot::setCommand(const robot::Command &command, SimBall
     return response;
 }
 
+btVector3 SimRobot::realPosition() const
+{
+    btTransform transform;
+    m_motionState->getWorldTransform(transform);
+    return transform.getOrigin() / SIMULATOR_SCALE;
+}
+
 void SimRobot::update(SSL_DetectionRobot *robot, float stddev_p, float stddev_phi)
 {
     // setup vision packet
@@ -39,11 +39,13 @@ public:
 public:
     void begin(SimBall *ball, double time);
     bool canKickBall(SimBall *ball) const;
+    bool isKickArmed() const;
     void tryKick(SimBall *ball, float power, double time);
     robot::RadioResponse setCommand(const robot::Command &command, SimBall *ball, bool charge);
     void update(SSL_DetectionRobot *robot, float stddev_p, float stddev_phi);
     void move(const amun::SimulatorMoveRobot &robot);
     bool isFlipped();
+    btVector3 realPosition() const;
 
     const robot::Specs& specs() const { return m_specs; }
 
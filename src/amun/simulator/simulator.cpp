@@ -28,6 +28,7 @@
 #include "simrobot.h"
 #include <QTimer>
 #include <algorithm>
+#include <cmath>
 
 /* Friction and restitution between robots, ball and field: (empirical measurments)
  * Ball vs. Robot:
@@ -56,9 +57,80 @@
  * => f_b = 1; f_f = 0.35; f_r = 0.22
  */
 
+// the adaptive mode refines SUB_TIMESTEP close to contacts, larger steps break the rolling friction
+const float SUB_TIMESTEP_MIN = 1/400.f;
+// faster balls are simulated with the smallest sub timestep when close to an obstacle
+const float FAST_BALL_SPEED = 2.0f;
+const float MAX_ROBOT_SPEED = 4.0f;
+const float CONTACT_MARGIN = 0.05f;
+
+// accumulated time spent in the simulation phases, in nanoseconds
+struct SimulatorTiming
+{
+    SimulatorTiming() { reset(); }
+    void reset() { collision = narrowphase = solver = robots = ball = vision = 0; }
+
+    qint64 collision;
+    qint64 narrowphase;
+    qint64 solver;
+    qint64 robots;
+    qint64 ball;
+    qint64 vision;
+};
+
+class ProfilingDispatcher : public btCollisionDispatcher
+{
+public:
+    ProfilingDispatcher(btCollisionConfiguration *collisionConfiguration, SimulatorTiming *timing) :
+        btCollisionDispatcher(collisionConfiguration),
+        m_timing(timing)
+    {}
+
+    void dispatchAllCollisionPairs(btOverlappingPairCache *pairCache, const btDispatcherInfo &dispatchInfo,
+                                   btDispatcher *dispatcher) override
+    {
+        const qint64 start = Timer::systemTime();
+        btCollisionDispatcher::dispatchAllCollisionPairs(pairCache, dispatchInfo, dispatcher);
+        m_timing->narrowphase += Timer::systemTime() - start;
+    }
+
+private:
+    SimulatorTiming *m_timing;
+};
+
+class ProfilingDynamicsWorld : public btDiscreteDynamicsWorld
+{
+public:
+    ProfilingDynamicsWorld(btDispatcher *dispatcher, btBroadphaseInterface *pairCache, btConstraintSolver *constraintSolver,
+                           btCollisionConfiguration *collisionConfiguration, SimulatorTiming *timing) :
+        btDiscreteDynamicsWorld(dispatcher, pairCache, constraintSolver, collisionConfiguration),
+        m_timing(timing)
+    {}
+
+    // includes the broad- and the narrowphase
+    void performDiscreteCollisionDetection() override
+    {
+        const qint64 start = Timer::systemTime();
+        btDiscreteDynamicsWorld::performDiscreteCollisionDetection();
+        m_timing->collision += Timer::systemTime() - start;
+    }
+
+protected:
+    void solveConstraints(btContactSolverInfo &solverInfo) override
+    {
+        const qint64 start = Timer::systemTime();
+        btDiscreteDynamicsWorld::solveConstraints(solverInfo);
+        m_timing->solver += Timer::systemTime() - start;
+    }
+
+private:
+    SimulatorTiming *m_timing;
+};
+
 struct SimulatorData
 {
     RNG rng;
+    SimulatorTiming timing;
     btDefaultCollisionConfiguration *collision;
     btCollisionDispatcher *dispatcher;
     btBroadphaseInterface *overlappingPairCache;
@@ -88,14 +160,17 @@ static void simulatorTickCallback(btDynamicsWorld *world, btScalar timeStep)
  */
 
 Simulator::Simulator(const Timer *timer) :
+    m_deliverySequence(0),
     m_timer(timer),
     m_time(0),
-    m_lastSentStatusTime(0),
+    m_lastGeometryTime(0),
     m_timeScaling(1.f),
     m_enabled(false),
     m_charge(false),
     m_visionDelay(35 * 1000 * 1000),
-    m_visionProcessingTime(5 * 1000 * 1000)
+    m_visionProcessingTime(5 * 1000 * 1000),
+    m_radioResponseDelay(0),
+    m_adaptiveSubstep(false)
 {
     // triggers by default every 5 milliseconds if simulator is enabled
     // timing may change if time is scaled
@@ -103,13 +178,21 @@ Simulator::Simulator(const Timer *timer) :
     m_trigger->setTimerType(Qt::PreciseTimer);
     connect(m_trigger, SIGNAL(timeout()), SLOT(process()));
 
+    // vision packets and radio responses are released in simulated time,
+    // a single timer is always armed for the earliest pending delivery
+    m_deliveryTimer = new QTimer(this);
+    m_deliveryTimer->setTimerType(Qt::PreciseTimer);
+    m_deliveryTimer->setSingleShot(true);
+    connect(m_deliveryTimer, SIGNAL(timeout()), SLOT(deliver()));
+
     // setup bullet
     m_data = new SimulatorData;
     m_data->collision = new btDefaultCollisionConfiguration();
-    m_data->dispatcher = new btCollisionDispatcher(m_data->collision);
+    m_data->dispatcher = new ProfilingDispatcher(m_data->collision, &m_data->timing);
     m_data->overlappingPairCache = new btDbvtBroadphase();
     m_data->solver = new btSequentialImpulseConstraintSolver;
-    m_data->dynamicsWorld = new btDiscreteDynamicsWorld(m_data->dispatcher, m_data->overlappingPairCache, m_data->solver, m_data->collision);
+    m_data->dynamicsWorld = new ProfilingDynamicsWorld(m_data->dispatcher, m_data->overlappingPairCache, m_data->solver,
+                                                       m_data->collision, &m_data->timing);
     m_data->dynamicsWorld->setGravity(btVector3(0.0f, 0.0f, -9.81f * SIMULATOR_SCALE));
     m_data->dynamicsWorld->setInternalTickCallback(simulatorTickCallback, this, true);
 
@@ -117,19 +200,19 @@ Simulator::Simulator(const Timer *timer) :
 
     // add field and ball
     m_data->field = new SimField(m_data->dynamicsWorld, m_data->geometry);
-    m_data->ball = new SimBall(&m_data->rng, m_data->dynamicsWorld, m_data->geometry.field_width(), m_data->geometry.field_height());
+    m_data->ball = new SimBall(&m_data->rng, m_data->dynamicsWorld);
     m_data->flip = false;
     m_data->stddevBall = 0.0f;
     m_data->stddevRobot = 0.0f;
     m_data->stddevRobotPhi = 0.0f;
 
+    setupCameras();
+
     // no robots after initialisation
 }
 
 Simulator::~Simulator()
 {
-    resetVisionPackets();
-
     qDeleteAll(m_data->robotsBlue);
     qDeleteAll(m_data->robotsYellow);
     delete m_data->ball;
@@ -148,6 +231,10 @@ void Simulator::process()
     const qint64 start_time = Timer::systemTime();
 
     const qint64 current_time = m_timer->currentTime();
+    m_data->timing.reset();
+
+    // the delivery timer may lag behind if time is scaled up a lot
+    deliverUntil(current_time);
 
     // collect responses from robots
     QList<robot::RadioResponse> responses;
@@ -177,36 +264,66 @@ void Simulator::process()
     }
 
     // radio responses are sent when a robot gets his command
-    // thus send the responses immediatelly
-    sendRadioResponses(responses);
+    if (!responses.isEmpty()) {
+        Delivery delivery;
+        delivery.type = Delivery::RadioResponses;
+        delivery.releaseTime = m_time + m_radioResponseDelay;
+        delivery.responses = responses;
+        enqueueDelivery(delivery);
+    }
 
     // simulate to current strategy time
     double timeDelta = (current_time - m_time) / 1E9;
-    m_data->dynamicsWorld->stepSimulation(timeDelta, 10, SUB_TIMESTEP);
+    const float subStep = subTimestep(timeDelta);
+    // allow catching up as much time as with the default sub timestep
+    const int maxSubSteps = std::ceil(10 * SUB_TIMESTEP / subStep);
+    m_data->dynamicsWorld->stepSimulation(timeDelta, maxSubSteps, subStep);
     m_time = current_time;
 
-    // only send a vision packet every third frame = 15 ms - epsilon (=half frame)
-    // gives a vision frequency of 66.67Hz
-    if (m_lastSentStatusTime + 12500000 <= m_time) {
-        QByteArray data = createVisionPacket();
-        m_visionPackets.enqueue(data);
+    // every camera captures frames with its own rate and phase
+    const qint64 visionStart = Timer::systemTime();
+    bool withGeometry = (m_lastGeometryTime == 0 || m_lastGeometryTime + 1000*1000*1000 <= m_time);
+    for (SimCamera &camera: m_cameras) {
+        if (camera.nextFrame == 0) {
+            camera.nextFrame = m_time + camera.phaseOffset;
+        }
+        if (camera.nextFrame > m_time) {
+            continue;
+        }
+        // the world state is only available for the current time, thus skip missed frames
+        while (camera.nextFrame <= m_time) {
+            camera.nextFrame += camera.interval;
+        }
+        camera.frameNumber++;
 
-        // timeout is in milliseconds
-        int timeout = m_visionDelay * 1E-6 / m_timeScaling;
-        // send after timeout, default timer mode, may jitter a bit
-        QTimer *timer = new QTimer();
-        timer->setTimerType(Qt::PreciseTimer);
-        timer->setSingleShot(true);
-        connect(timer, SIGNAL(timeout()), SLOT(sendVisionPacket()));
-        timer->start(timeout);
-        m_visionTimers.enqueue(timer);
+        if (camera.dropout > 0 && m_data->rng.uniform() < camera.dropout) {
+            continue;
+        }
 
-        m_lastSentStatusTime = m_time;
+        Delivery delivery;
+        delivery.type = Delivery::VisionPacket;
+        delivery.releaseTime = m_time + m_visionDelay;
+        delivery.visionPacket = createVisionPacket(camera, withGeometry);
+        enqueueDelivery(delivery);
+        if (withGeometry) {
+            // geometry is only sent about once per second
+            m_lastGeometryTime = m_time;
+            withGeometry = false;
+        }
     }
+    m_data->timing.vision = Timer::systemTime() - visionStart;
 
     // send timing information
+    const SimulatorTiming &t = m_data->timing;
     Status status(new amun::Status);
-    status->mutable_timing()->set_simulator((Timer::systemTime() - start_time) / 1E9);
+    amun::Timing *timing = status->mutable_timing();
+    timing->set_simulator((Timer::systemTime() - start_time) / 1E9);
+    timing->set_simulator_broadphase((t.collision - t.narrowphase) / 1E9);
+    timing->set_simulator_narrowphase(t.narrowphase / 1E9);
+    timing->set_simulator_solver(t.solver / 1E9);
+    timing->set_simulator_robots(t.robots / 1E9);
+    timing->set_simulator_ball(t.ball / 1E9);
+    timing->set_simulator_vision(t.vision / 1E9);
     emit sendStatus(status);
 }
 
@@ -236,47 +353,170 @@ void Simulator::handleSimulatorTick(double timeStep)
     resetFlipped(m_data->robotsYellow, -1.0f);
 
     // apply commands and forces to ball and robots
-    m_data->ball->begin();
+    const qint64 ballStart = Timer::systemTime();
+    m_data->ball->begin(timeStep);
+    const qint64 robotsStart = Timer::systemTime();
     foreach (SimRobot *robot, m_data->robotsBlue) {
         robot->begin(m_data->ball, timeStep);
     }
     foreach (SimRobot *robot, m_data->robotsYellow) {
         robot->begin(m_data->ball, timeStep);
     }
+    m_data->timing.ball += robotsStart - ballStart;
+    m_data->timing.robots += Timer::systemTime() - robotsStart;
 
     // add gravity to all ACTIVE objects
     // thus has to be done after applying commands
     m_data->dynamicsWorld->applyGravity();
 }
 
-QByteArray Simulator::createVisionPacket()
+float Simulator::subTimestep(double timeDelta) const
 {
-    // setup vision packet
-    SSL_WrapperPacket packet;
-    SSL_DetectionFrame *detection = packet.mutable_detection();
-    detection->set_frame_number(0);
-    detection->set_camera_id(0);
-    detection->set_t_capture((m_time + m_visionDelay - m_visionProcessingTime)*1E-9);
-    detection->set_t_sent((m_time + m_visionDelay)*1E-9);
+    if (!m_adaptiveSubstep) {
+        return SUB_TIMESTEP;
+    }
 
-    // get ball and robot position
-    int cameraId = m_data->ball->update(detection->add_balls(), m_data->stddevBall);
-    if (cameraId >= 0) {
-        // just move everything to the ball camera
-        detection->set_camera_id(cameraId);
-    } else {
-        // ball not visible
-        detection->clear_balls();
+    const btVector3 ballPos = m_data->ball->realPosition();
+    const float ballSpeed = (m_data->ball->speed() / SIMULATOR_SCALE).length();
+    // the sub timestep is chosen again after this interval
+    const float lookahead = timeDelta + SUB_TIMESTEP;
+    const float ballReach = BALL_RADIUS + ballSpeed * lookahead + CONTACT_MARGIN;
+
+    bool contactPending = false;
+    bool kickPending = false;
+    const Simulator::RobotMap *teams[] = { &m_data->robotsBlue, &m_data->robotsYellow };
+    for (const Simulator::RobotMap *team: teams) {
+        foreach (const SimRobot *robot, *team) {
+            const btVector3 robotPos = robot->realPosition();
+            const btVector3 diff(robotPos.x() - ballPos.x(), robotPos.y() - ballPos.y(), 0);
+            const float distance = diff.length() - robot->specs().radius();
+            if (distance < ballReach + MAX_ROBOT_SPEED * lookahead) {
+                contactPending = true;
+                kickPending |= robot->isKickArmed();
+            }
+        }
     }
-    foreach (SimRobot *robot, m_data->robotsBlue) {
-        robot->update(detection->add_robots_blue(), m_data->stddevRobot, m_data->stddevRobotPhi);
+
+    // walls around the field and the goals
+    const world::Geometry &g = m_data->geometry;
+    const float wallX = g.field_width() / 2 + g.boundary_width();
+    const float wallY = g.field_height() / 2 + g.boundary_width();
+    if (std::abs(ballPos.x()) > wallX - ballReach || std::abs(ballPos.y()) > wallY - ballReach) {
+        contactPending = true;
     }
-    foreach (SimRobot *robot, m_data->robotsYellow) {
-        robot->update(detection->add_robots_yellow(), m_data->stddevRobot, m_data->stddevRobotPhi);
+    if (std::abs(ballPos.y()) > g.field_height() / 2 - ballReach
+            && std::abs(ballPos.x()) < g.goal_width() / 2 + g.goal_wall_width() + ballReach) {
+        contactPending = true;
+    }
+
+    // kicks and fast collisions require a fine resolution
+    if (contactPending && (kickPending || ballSpeed > FAST_BALL_SPEED)) {
+        return SUB_TIMESTEP_MIN;
+    }
+    return SUB_TIMESTEP;
+}
+
+void Simulator::setupCameras()
+{
+    const int cameraCount = std::max(1u, m_visionConfig.camera_count());
+
+    // use the most quadratic grid, the longer side is split along the field length
+    int rows = 1;
+    for (int i = 1; i * i <= cameraCount; ++i) {
+        if (cameraCount % i == 0) {
+            rows = i;
+        }
+    }
+    const int cols = cameraCount / rows;
+
+    // cameras cover the whole field including the boundary
+    const float width = m_data->geometry.field_width() + 2 * m_data->geometry.boundary_width();
+    const float height = m_data->geometry.field_height() + 2 * m_data->geometry.boundary_width();
+    const float cellWidth = width / rows;
+    const float cellHeight = height / cols;
+    const float overlap = std::max(0.f, m_visionConfig.overlap()) / 2;
+
+    m_cameras.clear();
+    for (int i = 0; i < cameraCount; ++i) {
+        const amun::SimulatorCamera &config = (i < m_visionConfig.camera_size())
+                ? m_visionConfig.camera(i) : amun::SimulatorCamera::default_instance();
+
+        // numbering starts at the corner with negative x and y, first along the x axis
+        const int row = i % rows;
+        const int col = i / rows;
+
+        SimCamera camera;
+        camera.id = i;
+        camera.minX = -width / 2 + row * cellWidth;
+        camera.maxX = camera.minX + cellWidth;
+        camera.minY = -height / 2 + col * cellHeight;
+        camera.maxY = camera.minY + cellHeight;
+        camera.x = (camera.minX + camera.maxX) / 2;
+        camera.y = (camera.minY + camera.maxY) / 2;
+        camera.height = m_visionConfig.camera_height();
+        // adjacent cameras see an overlapping area
+        camera.minX -= (row > 0) ? overlap : 0;
+        camera.maxX += (row < rows - 1) ? overlap : 0;
+        camera.minY -= (col > 0) ? overlap : 0;
+        camera.maxY += (col < cols - 1) ? overlap : 0;
+
+        const float frameRate = config.has_frame_rate() ? config.frame_rate() : m_visionConfig.frame_rate();
+        camera.interval = 1E9 / std::max(1.f, frameRate);
+        if (config.has_phase_offset()) {
+            camera.phaseOffset = config.phase_offset();
+        } else {
+            camera.phaseOffset = (m_visionConfig.stagger()) ? camera.interval * i / cameraCount : 0;
+        }
+        camera.nextFrame = 0;
+        camera.frameNumber = 0;
+        camera.dropout = config.has_dropout() ? config.dropout() : m_visionConfig.dropout();
+        camera.stddevScale = config.stddev_scale();
+        m_cameras.append(camera);
+    }
+
+    // the tracker requires the new camera positions
+    m_lastGeometryTime = 0;
+}
+
+bool Simulator::isBallOccluded(const SimCamera &camera) const
+{
+    const btVector3 ball = m_data->ball->realPosition();
+    const btVector3 cameraPos(camera.x, camera.y, camera.height);
+    const btVector3 toCamera = cameraPos - ball;
+    if (toCamera.z() <= 0) {
+        return false;
+    }
+
+    const Simulator::RobotMap *teams[] = { &m_data->robotsBlue, &m_data->robotsYellow };
+    for (const Simulator::RobotMap *team: teams) {
+        foreach (const SimRobot *robot, *team) {
+            const float robotHeight = robot->specs().height();
+            if (ball.z() >= robotHeight) {
+                continue;
+            }
+            // the line of sight from the ball to the camera leaves the robot
+            // cylinder at its top, check the ground projection of that part
+            const btVector3 robotPos = robot->realPosition();
+            const float t = (robotHeight - ball.z()) / toCamera.z();
+            const btVector3 top = ball + toCamera * t;
+
+            const btVector3 start(ball.x(), ball.y(), 0);
+            const btVector3 segment(top.x() - ball.x(), top.y() - ball.y(), 0);
+            const btVector3 toRobot(robotPos.x() - ball.x(), robotPos.y() - ball.y(), 0);
+            const float length2 = segment.length2();
+            const float u = (length2 > 0) ? std::max(0.f, std::min(1.f, toRobot.dot(segment) / length2)) : 0;
+            const btVector3 nearest = start + segment * u;
+            const btVector3 dist(robotPos.x() - nearest.x(), robotPos.y() - nearest.y(), 0);
+            if (dist.length() < robot->specs().radius()) {
+                return true;
+            }
+        }
     }
+    return false;
+}
 
-    // add field geometry
-    SSL_GeometryData *geometry = packet.mutable_geometry();
+void Simulator::addGeometry(SSL_GeometryData *geometry) const
+{
     SSL_GeometryFieldSize *field = geometry->mutable_field();
     field->set_line_width(m_data->geometry.line_width() * 1000.0f);
     field->set_field_width(m_data->geometry.field_width() * 1000.0f);
@@ -293,17 +533,9 @@ QByteArray Simulator::createVisionPacket()
     field->set_penalty_spot_from_field_line_dist(m_data->geometry.penalty_spot_from_field_line_dist() * 1000.0f);
     field->set_penalty_line_from_spot_dist(m_data->geometry.penalty_line_from_spot_dist() * 1000.0f);
 
-    for (int i = 0; i < 4; ++i) {
-        int signX = (i&1) ? 1 : -1;
-        int signY = (i&2) ? 1 : -1;
-
-        // must match SimBall
-        const float cameraX = m_data->geometry.field_width() / 4;
-        const float cameraY = m_data->geometry.field_height() / 4;
-        const float cameraZ = 4.f;
-
+    foreach (const SimCamera &camera, m_cameras) {
         SSL_GeometryCameraCalibration *calib = geometry->add_calib();
-        calib->set_camera_id(i);
+        calib->set_camera_id(camera.id);
         // DUMMY VALUES
         calib->set_distortion(0.2);
         calib->set_focal_length(390);
@@ -317,9 +549,47 @@ QByteArray Simulator::createVisionPacket()
         calib->set_ty(0);
         calib->set_tz(3500);
 
-        calib->set_derived_camera_world_tx(cameraY * 1000 * signY);
-        calib->set_derived_camera_world_ty(-cameraX * 1000 * signX);
-        calib->set_derived_camera_world_tz(cameraZ * 1000);
+        // rotate to ssl-vision coordinates
+        calib->set_derived_camera_world_tx(camera.y * 1000);
+        calib->set_derived_camera_world_ty(-camera.x * 1000);
+        calib->set_derived_camera_world_tz(camera.height * 1000);
+    }
+}
+
+QByteArray Simulator::createVisionPacket(const SimCamera &camera, bool withGeometry)
+{
+    // setup vision packet
+    SSL_WrapperPacket packet;
+    SSL_DetectionFrame *detection = packet.mutable_detection();
+    detection->set_frame_number(camera.frameNumber);
+    detection->set_camera_id(camera.id);
+    detection->set_t_capture((m_time + m_visionDelay - m_visionProcessingTime)*1E-9);
+    detection->set_t_sent((m_time + m_visionDelay)*1E-9);
+
+    // get ball and robot position
+    if (!m_data->ball->update(detection->add_balls(), m_data->stddevBall * camera.stddevScale, camera)
+            || isBallOccluded(camera)) {
+        // ball not visible
+        detection->clear_balls();
+    }
+
+    const float stddevRobot = m_data->stddevRobot * camera.stddevScale;
+    const float stddevRobotPhi = m_data->stddevRobotPhi * camera.stddevScale;
+    foreach (SimRobot *robot, m_data->robotsBlue) {
+        const btVector3 p = robot->realPosition();
+        if (p.x() >= camera.minX && p.x() <= camera.maxX && p.y() >= camera.minY && p.y() <= camera.maxY) {
+            robot->update(detection->add_robots_blue(), stddevRobot, stddevRobotPhi);
+        }
+    }
+    foreach (SimRobot *robot, m_data->robotsYellow) {
+        const btVector3 p = robot->realPosition();
+        if (p.x() >= camera.minX && p.x() <= camera.maxX && p.y() >= camera.minY && p.y() <= camera.maxY) {
+            robot->update(detection->add_robots_yellow(), stddevRobot, stddevRobotPhi);
+        }
+    }
+
+    if (withGeometry) {
+        addGeometry(packet.mutable_geometry());
     }
 
     // serialize "vision packet"
@@ -331,21 +601,53 @@ QByteArray Simulator::createVisionPacket()
     return QByteArray();
 }
 
-void Simulator::sendVisionPacket()
+void Simulator::enqueueDelivery(Delivery &delivery)
+{
+    delivery.sequence = m_deliverySequence++;
+    m_deliveries.push(delivery);
+    // only rearm the timer if the new delivery is due first
+    if (m_deliveries.top().sequence == delivery.sequence) {
+        scheduleDelivery();
+    }
+}
+
+void Simulator::deliverUntil(qint64 time)
+{
+    while (!m_deliveries.empty() && m_deliveries.top().releaseTime <= time) {
+        const Delivery delivery = m_deliveries.top();
+        m_deliveries.pop();
+        if (delivery.type == Delivery::VisionPacket) {
+            // the receive time is exactly the simulated latency after the capture
+            emit gotPacket(delivery.visionPacket, delivery.releaseTime);
+        } else {
+            emit sendRadioResponses(delivery.responses);
+        }
+    }
+}
+
+void Simulator::deliver()
 {
-    QByteArray data = m_visionPackets.dequeue();
-    emit gotPacket(data, m_timer->currentTime()); // send "vision packet" and assume instant receiving
-    // the receive time may be a bit jittered just like a real transmission
+    deliverUntil(m_timer->currentTime());
+    scheduleDelivery();
+}
+
+void Simulator::scheduleDelivery()
+{
+    if (m_deliveries.empty() || m_timeScaling <= 0 || !m_enabled) {
+        m_deliveryTimer->stop();
+        return;
+    }
 
-    QTimer *timer = m_visionTimers.dequeue();
-    timer->deleteLater();
+    // the release time is given in simulated time, the timer runs in realtime
+    const qint64 remaining = m_deliveries.top().releaseTime - m_timer->currentTime();
+    const double timeout = std::ceil(remaining * 1E-6 / m_timeScaling);
+    m_deliveryTimer->start(std::max(0, (int)timeout));
 }
 
-void Simulator::resetVisionPackets()
+void Simulator::resetDeliveries()
 {
-    qDeleteAll(m_visionTimers);
-    m_visionTimers.clear();
-    m_visionPackets.clear();
+    m_deliveries = DeliveryQueue();
+    m_deliveryTimer->stop();
 }
 
 void Simulator::handleRadioCommands(const QList<robot::RadioCommand> &commands)
@@ -364,8 +666,8 @@ void Simulator::setTeam(Simulator::RobotMap &list, float side, const robot::Team
     // thus the old robots will disappear immediatelly
     // however if the delayed vision packets arrive the old robots will be tracked again
     // thus after removing a robot from a team it can take 1 simulated second for the robot to disappear
-    // to prevent this remove outdated vision packets
-    resetVisionPackets();
+    // to prevent this remove outdated vision packets and radio responses
+    resetDeliveries();
 
     // align robots on a line
     const float x = m_data->geometry.field_width() / 2 - 0.2;
@@ -446,6 +748,19 @@ void Simulator::handleCommand(const Command &command)
             m_visionProcessingTime = std::max((qint64)0, (qint64)sim.vision_processing_time());
         }
 
+        if (sim.has_radio_response_delay()) {
+            m_radioResponseDelay = std::max((qint64)0, (qint64)sim.radio_response_delay());
+        }
+
+        if (sim.has_adaptive_substep()) {
+            m_adaptiveSubstep = sim.adaptive_substep();
+        }
+
+        if (sim.has_vision()) {
+            m_visionConfig.CopyFrom(sim.vision());
+            setupCameras();
+        }
+
         if (sim.has_stddev_ball_p()) {
             m_data->stddevBall = sim.stddev_ball_p();
         }
@@ -492,22 +807,22 @@ void Simulator::handleCommand(const Command &command)
 
 void Simulator::setScaling(float scaling)
 {
+    if (!m_enabled) {
+        // clear pending vision packets and radio responses
+        resetDeliveries();
+    }
+
     if (scaling <= 0 || !m_enabled) {
         m_trigger->stop();
-        // clear pending vision packets
-        resetVisionPackets();
     } else {
         // scale default timing of 5 milliseconds
         const int t = 5 / scaling;
         m_trigger->start(qMax(1, t));
-
-        // The vision packet timings are wrong after a scaling change
-        // In addition if the new scaling is larger than the old one,
-        // this would cause the timers started after the scaling change
-        // to trigger before the old timers, what causes the deletion of
-        // the old timers before they are fired.
-        resetVisionPackets();
     }
     // needed if scaling is set before simulator was enabled
     m_timeScaling = scaling;
+
+    // pending deliveries are kept as their release time is given in simulated time,
+    // only the timer interval changes. While paused nothing is released.
+    scheduleDelivery();
 }
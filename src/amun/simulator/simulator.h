@@ -27,7 +27,10 @@
 #include <QMap>
 #include <QPair>
 #include <QQueue>
+#include <QVector>
 #include <QByteArray>
+#include <queue>
+#include <vector>
 
 // higher values break the rolling friction of the ball
 const float SIMULATOR_SCALE = 10.0f;
@@ -37,9 +40,30 @@ const float COLLISION_MARGIN = 0.04f;
 class QByteArray;
 class QTimer;
 class SimRobot;
+class SSL_GeometryData;
 struct SimulatorData;
 class Timer;
 
+struct SimCamera
+{
+    int id;
+    // camera position, in m
+    float x;
+    float y;
+    float height;
+    // area covered by the camera
+    float minX;
+    float maxX;
+    float minY;
+    float maxY;
+    qint64 interval;
+    qint64 phaseOffset;
+    qint64 nextFrame;
+    quint32 frameNumber;
+    float dropout;
+    float stddevScale;
+};
+
 class Simulator : public QObject
 {
     Q_OBJECT
@@ -63,33 +87,69 @@ public slots:
 
 private slots:
     void process();
-    void sendVisionPacket();
+    void deliver();
 
 private:
 
     void resetFlipped(RobotMap &robots, float side);
-    QByteArray createVisionPacket();
-    void resetVisionPackets();
+    float subTimestep(double timeDelta) const;
+    void setupCameras();
+    QByteArray createVisionPacket(const SimCamera &camera, bool withGeometry);
+    void addGeometry(SSL_GeometryData *geometry) const;
+    bool isBallOccluded(const SimCamera &camera) const;
     void setTeam(RobotMap &list, float side, const robot::Team &team);
     void moveBall(const amun::SimulatorMoveBall &ball);
     void moveRobot(const RobotMap &list, const amun::SimulatorMoveRobot &robot);
 
+private:
+    struct Delivery
+    {
+        enum Type { VisionPacket, RadioResponses };
+        Type type;
+        // simulated time at which the data is received by amun
+        qint64 releaseTime;
+        // keeps the insertion order for equal release times
+        quint64 sequence;
+        QByteArray visionPacket;
+        QList<robot::RadioResponse> responses;
+
+        // std::priority_queue returns the largest element, thus invert the order
+        bool operator<(const Delivery &other) const
+        {
+            if (releaseTime != other.releaseTime) {
+                return releaseTime > other.releaseTime;
+            }
+            return sequence > other.sequence;
+        }
+    };
+    typedef std::priority_queue<Delivery, std::vector<Delivery> > DeliveryQueue;
+
+    void enqueueDelivery(Delivery &delivery);
+    void deliverUntil(qint64 time);
+    void scheduleDelivery();
+    void resetDeliveries();
+
 private:
     typedef QPair<QList<robot::RadioCommand>, qint64> RadioCommand;
     SimulatorData *m_data;
     QQueue<RadioCommand> m_radioCommands;
-    QQueue<QByteArray> m_visionPackets;
-    QQueue<QTimer *> m_visionTimers;
+    DeliveryQueue m_deliveries;
+    quint64 m_deliverySequence;
     const Timer *m_timer;
     QTimer *m_trigger;
+    QTimer *m_deliveryTimer;
     qint64 m_time;
-    qint64 m_lastSentStatusTime;
+    qint64 m_lastGeometryTime;
+    amun::SimulatorVision m_visionConfig;
+    QVector<SimCamera> m_cameras;
     float m_timeScaling;
     bool m_enabled;
     bool m_charge;
     // systemDelay + visionProcessingTime = visionDelay
     qint64 m_visionDelay;
     qint64 m_visionProcessingTime;
+    qint64 m_radioResponseDelay;
+    bool m_adaptiveSubstep;
 };
 
 #endif // SIMULATOR_H
@@ -0,0 +1,375 @@
+/***************************************************************************
+ *   Copyright 2016 Robotics Erlangen e.V.                                 *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include "statusserver.h"
+#include "core/timer.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QtEndian>
+#include <algorithm>
+
+/*!
+ * \class StatusServer
+ * \ingroup amun
+ * \brief Serves the status stream to remote clients
+ *
+ * Every client selects the transmitted parts of the status using a
+ * StatusSubscription. Statuses are merged until the rate limit of a client
+ * allows the next transmission, then delta encoded and compressed. Each
+ * message is preceded by its length as 32 bit big endian integer, clients
+ * send their subscription using the same framing.
+ */
+
+// time between checks for due transmissions, in ms
+static const int FLUSH_INTERVAL = 5;
+// transmissions are skipped while that much data is still queued for a client
+static const qint64 MAX_BACKLOG = 1024 * 1024;
+// limits the log output kept for stalled clients
+static const int MAX_PENDING_LOG = 1000;
+// larger subscription messages are considered as garbage
+static const quint32 MAX_REQUEST_SIZE = 64 * 1024;
+
+static bool isTransient(int fieldNumber)
+{
+    switch (fieldNumber) {
+    case amun::Status::kWorldStateFieldNumber:
+    case amun::Status::kDebugFieldNumber:
+    case amun::Status::kTimingFieldNumber:
+    case amun::Status::kRadioFieldNumber:
+    case amun::Status::kRadioCommandFieldNumber:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool isSubscribed(const amun::StatusSubscription &subscription, int fieldNumber)
+{
+    switch (fieldNumber) {
+    case amun::Status::kWorldStateFieldNumber:
+        // also required to plot the robot and ball values
+        return subscription.field() || subscription.plots();
+    case amun::Status::kGameStateFieldNumber:
+    case amun::Status::kGeometryFieldNumber:
+    case amun::Status::kGeometryVersionFieldNumber:
+    case amun::Status::kTeamBlueFieldNumber:
+    case amun::Status::kTeamYellowFieldNumber:
+    case amun::Status::kUserInputBlueFieldNumber:
+    case amun::Status::kUserInputYellowFieldNumber:
+        return subscription.field();
+    case amun::Status::kTimingFieldNumber:
+    case amun::Status::kRadioFieldNumber:
+    case amun::Status::kRadioCommandFieldNumber:
+        return subscription.plots();
+    default:
+        return true;
+    }
+}
+
+/*!
+ * \brief Replaces the fields which are set in from and accepted by filter
+ *
+ * Other fields of to are kept. Debug values are skipped as these have to be
+ * merged per source.
+ * \return true if any field was copied
+ */
+template<class Filter>
+static bool replaceFields(const amun::Status &from, amun::Status *to, Filter filter)
+{
+    const google::protobuf::Reflection *refl = from.GetReflection();
+    std::vector<const google::protobuf::FieldDescriptor *> fields;
+    refl->ListFields(from, &fields);
+
+    bool changed = false;
+    for (const google::protobuf::FieldDescriptor *field : fields) {
+        if (field->cpp_type() != google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE
+                || field->number() == amun::Status::kDebugFieldNumber || !filter(field->number())) {
+            continue;
+        }
+
+        refl->ClearField(to, field);
+        if (field->is_repeated()) {
+            for (int i = 0; i < refl->FieldSize(from, field); ++i) {
+                refl->AddMessage(to, field)->CopyFrom(refl->GetRepeatedMessage(from, field, i));
+            }
+        } else {
+            refl->MutableMessage(to, field)->CopyFrom(refl->GetMessage(from, field));
+        }
+        changed = true;
+    }
+    return changed;
+}
+
+StatusServer::StatusServer(QObject *parent) :
+    QObject(parent),
+    m_tcpServer(NULL),
+    m_localServer(NULL)
+{
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setInterval(FLUSH_INTERVAL);
+    connect(m_flushTimer, &QTimer::timeout, this, &StatusServer::flush);
+}
+
+StatusServer::~StatusServer()
+{
+    close();
+}
+
+void StatusServer::handleCommand(const Command &command)
+{
+    if (command->has_amun() && command->amun().has_status_server()) {
+        listen(command->amun().status_server());
+    }
+}
+
+void StatusServer::listen(const amun::CommandStatusServer &config)
+{
+    close();
+    if (!config.enable()) {
+        return;
+    }
+
+    if (config.has_local_name()) {
+        const QString name = QString::fromStdString(config.local_name());
+        // remove socket file left behind by a crashed instance
+        QLocalServer::removeServer(name);
+        m_localServer = new QLocalServer(this);
+        connect(m_localServer, &QLocalServer::newConnection, this, &StatusServer::newConnection);
+        m_localServer->listen(name);
+    } else {
+        m_tcpServer = new QTcpServer(this);
+        connect(m_tcpServer, &QTcpServer::newConnection, this, &StatusServer::newConnection);
+        if (!m_tcpServer->listen(QHostAddress::Any, config.port())) {
+            Status status(new amun::Status);
+            status->mutable_amun_state()->mutable_port_bind_error()->set_port(config.port());
+            emit sendStatus(status);
+        }
+    }
+}
+
+void StatusServer::close()
+{
+    foreach (Client *client, m_clients) {
+        // deleting the socket emits disconnected, which would remove the client a second time
+        client->socket->disconnect(this);
+        delete client->socket;
+        delete client;
+    }
+    m_clients.clear();
+    m_flushTimer->stop();
+
+    delete m_tcpServer;
+    m_tcpServer = NULL;
+    delete m_localServer;
+    m_localServer = NULL;
+}
+
+void StatusServer::newConnection()
+{
+    while (m_tcpServer && m_tcpServer->hasPendingConnections()) {
+        QTcpSocket *socket = m_tcpServer->nextPendingConnection();
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        connect(socket, &QAbstractSocket::disconnected, this, &StatusServer::removeClient);
+        addClient(socket);
+    }
+    while (m_localServer && m_localServer->hasPendingConnections()) {
+        QLocalSocket *socket = m_localServer->nextPendingConnection();
+        connect(socket, &QLocalSocket::disconnected, this, &StatusServer::removeClient);
+        addClient(socket);
+    }
+}
+
+void StatusServer::addClient(QIODevice *socket)
+{
+    Client *client = new Client;
+    client->socket = socket;
+    client->hasPending = false;
+    client->lastSend = 0;
+    connect(socket, &QIODevice::readyRead, this, &StatusServer::readData);
+    m_clients.append(client);
+
+    // until the client has sent its subscription
+    subscribe(client, amun::StatusSubscription());
+    m_flushTimer->start();
+}
+
+StatusServer::Client *StatusServer::findClient(QObject *socket)
+{
+    foreach (Client *client, m_clients) {
+        if (client->socket == socket) {
+            return client;
+        }
+    }
+    return NULL;
+}
+
+void StatusServer::removeClient()
+{
+    Client *client = findClient(sender());
+    if (client == NULL) {
+        return;
+    }
+    m_clients.removeOne(client);
+    // called by the socket
+    client->socket->deleteLater();
+    delete client;
+
+    if (m_clients.isEmpty()) {
+        m_flushTimer->stop();
+    }
+}
+
+void StatusServer::readData()
+{
+    Client *client = findClient(sender());
+    if (client == NULL) {
+        return;
+    }
+
+    client->buffer.append(client->socket->readAll());
+    while (client->buffer.size() >= 4) {
+        const quint32 size = qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(client->buffer.constData()));
+        if (size > MAX_REQUEST_SIZE) {
+            // protocol violation, the disconnect removes the client
+            client->buffer.clear();
+            client->socket->close();
+            return;
+        }
+        if (quint32(client->buffer.size()) < 4 + size) {
+            break;
+        }
+
+        amun::StatusSubscription subscription;
+        if (subscription.ParseFromArray(client->buffer.constData() + 4, size)) {
+            subscribe(client, subscription);
+        }
+        client->buffer.remove(0, 4 + size);
+    }
+}
+
+void StatusServer::subscribe(Client *client, const amun::StatusSubscription &subscription)
+{
+    client->subscription = subscription;
+    // start a new delta chain with the current state
+    client->encoder.reset();
+    client->pending.Clear();
+    client->debug.clear();
+    client->hasPending = false;
+    merge(client, m_sticky);
+}
+
+void StatusServer::handleStatus(const Status &status)
+{
+    // remember everything a newly connected client needs to show the current state
+    if (replaceFields(*status, &m_sticky, [](int fieldNumber) { return !isTransient(fieldNumber); })) {
+        m_sticky.set_time(status->time());
+    }
+
+    foreach (Client *client, m_clients) {
+        merge(client, *status);
+    }
+}
+
+void StatusServer::merge(Client *client, const amun::Status &status)
+{
+    const amun::StatusSubscription &subscription = client->subscription;
+    if (replaceFields(status, &client->pending,
+                      [&subscription](int fieldNumber) { return isSubscribed(subscription, fieldNumber); })) {
+        client->hasPending = true;
+    }
+    client->pending.set_time(status.time());
+
+    if (!status.has_debug()) {
+        return;
+    }
+    const amun::DebugValues &debug = status.debug();
+    const bool allValues = std::find(subscription.debug_source().begin(), subscription.debug_source().end(),
+                                     debug.source()) != subscription.debug_source().end();
+    if (!allValues && !(subscription.plots() && debug.plot_size() > 0)) {
+        return;
+    }
+
+    amun::DebugValues &pending = client->debug[debug.source()];
+    if (allValues) {
+        // keep log output which wasn't sent yet
+        google::protobuf::RepeatedPtrField<amun::StatusLog> log;
+        log.Swap(pending.mutable_log());
+        pending.CopyFrom(debug);
+        if (log.size() > 0) {
+            log.MergeFrom(debug.log());
+            if (log.size() > MAX_PENDING_LOG) {
+                log.DeleteSubrange(0, log.size() - MAX_PENDING_LOG);
+            }
+            pending.mutable_log()->Swap(&log);
+        }
+    } else {
+        pending.set_source(debug.source());
+        pending.mutable_plot()->CopyFrom(debug.plot());
+    }
+}
+
+void StatusServer::flush()
+{
+    const qint64 now = Timer::systemTime();
+    foreach (Client *client, m_clients) {
+        if (!client->hasPending && client->debug.isEmpty()) {
+            continue;
+        }
+        const qint64 interval = 1E9 / std::max(client->subscription.max_rate(), 1.f);
+        if (now - client->lastSend < interval) {
+            continue;
+        }
+        // slow clients skip updates, the pending status always holds the latest values
+        if (client->socket->bytesToWrite() > MAX_BACKLOG) {
+            continue;
+        }
+        client->lastSend = now;
+
+        const qint64 time = client->pending.time();
+        if (client->hasPending) {
+            send(client, client->pending);
+            client->pending.Clear();
+            client->hasPending = false;
+        }
+        // a status can only hold the debug values of a single source
+        for (auto it = client->debug.begin(); it != client->debug.end(); ++it) {
+            amun::Status status;
+            status.set_time(time);
+            status.mutable_debug()->Swap(&it.value());
+            send(client, status);
+        }
+        client->debug.clear();
+    }
+}
+
+void StatusServer::send(Client *client, const amun::Status &status)
+{
+    client->encoder.encode(status, &m_encoded);
+    const std::string data = m_encoded.SerializeAsString();
+    const QByteArray compressed = qCompress(reinterpret_cast<const uchar *>(data.data()), int(data.size()));
+
+    uchar header[4];
+    qToBigEndian<quint32>(compressed.size(), header);
+    client->socket->write(reinterpret_cast<const char *>(header), sizeof(header));
+    client->socket->write(compressed);
+}
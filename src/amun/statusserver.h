@@ -0,0 +1,90 @@
+/***************************************************************************
+ *   Copyright 2016 Robotics Erlangen e.V.                                 *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef STATUSSERVER_H
+#define STATUSSERVER_H
+
+#include "protobuf/command.h"
+#include "protobuf/status.h"
+#include "protobuf/statusdelta.h"
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+
+class QIODevice;
+class QLocalServer;
+class QTcpServer;
+class QTimer;
+
+class StatusServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StatusServer(QObject *parent = 0);
+    ~StatusServer() override;
+
+signals:
+    void sendStatus(const Status &status);
+
+public slots:
+    void handleStatus(const Status &status);
+    void handleCommand(const Command &command);
+
+private slots:
+    void newConnection();
+    void readData();
+    void removeClient();
+    void flush();
+
+private:
+    struct Client
+    {
+        QIODevice *socket;
+        QByteArray buffer;
+        amun::StatusSubscription subscription;
+        StatusDeltaEncoder encoder;
+        // merged status since the last transmission
+        amun::Status pending;
+        bool hasPending;
+        // debug values are merged per source
+        QMap<int, amun::DebugValues> debug;
+        qint64 lastSend;
+    };
+
+    void listen(const amun::CommandStatusServer &config);
+    void close();
+    void addClient(QIODevice *socket);
+    Client *findClient(QObject *socket);
+    void subscribe(Client *client, const amun::StatusSubscription &subscription);
+    void merge(Client *client, const amun::Status &status);
+    void send(Client *client, const amun::Status &status);
+
+private:
+    QTcpServer *m_tcpServer;
+    QLocalServer *m_localServer;
+    QList<Client *> m_clients;
+    QTimer *m_flushTimer;
+    // latest value of every non-transient status field, sent to new clients
+    amun::Status m_sticky;
+    amun::Status m_encoded;
+};
+
+#endif // STATUSSERVER_H
@@ -26,9 +26,41 @@ void AbstractStrategyScript::clearDebug()
     m_debug.clear_visualization();
     m_debug.clear_log();
     m_debug.clear_plot();
+    m_shapeCount = 0;
+    m_droppedShapes = 0;
 }
 
 void AbstractStrategyScript::setSelectedOptions(const QStringList &options)
 {
     m_selectedOptions = options;
 }
+
+void AbstractStrategyScript::setVisualizationFilter(const amun::CommandStrategyVisualizations &filter)
+{
+    QSet<QByteArray> enabled;
+    for (const std::string &name: filter.enabled()) {
+        enabled.insert(QByteArray(name.data(), name.size()));
+    }
+    // unknown visualizations must still be sent, otherwise they could never be enabled
+    m_hiddenVisualizations.clear();
+    for (const std::string &name: filter.known()) {
+        const QByteArray n(name.data(), name.size());
+        if (!enabled.contains(n)) {
+            m_hiddenVisualizations.insert(n);
+        }
+    }
+    m_maxShapes = filter.max_shapes();
+}
+
+bool AbstractStrategyScript::acceptVisualization(const char *name)
+{
+    if (name && m_hiddenVisualizations.contains(QByteArray::fromRawData(name, qstrlen(name)))) {
+        return false;
+    }
+    if (m_shapeCount >= m_maxShapes) {
+        m_droppedShapes++;
+        return false;
+    }
+    m_shapeCount++;
+    return true;
+}
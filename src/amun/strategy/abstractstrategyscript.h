@@ -29,9 +29,11 @@
 #include "protobuf/world.pb.h"
 #include "strategytype.h"
 #include <QObject>
+#include <QSet>
 #include <QString>
 #include <QStringList>
 
+class StrategyProfiler;
 class Timer;
 
 class AbstractStrategyScript : public QObject
@@ -52,6 +54,9 @@ public:
     virtual bool process(double &pathPlanning, const world::State &worldState, const amun::GameState &refereeState, const amun::UserInput &userInput) = 0;
 
     void setSelectedOptions(const QStringList &options);
+    void setVisualizationFilter(const amun::CommandStrategyVisualizations &filter);
+    // the profiler is owned by the caller and outlives reloads
+    void setProfiler(StrategyProfiler *profiler) { m_profiler = profiler; }
 
     // getter functions
     QString errorMsg() const { return m_errorMsg; }
@@ -66,6 +71,10 @@ public:
 
 protected:
     void clearDebug();
+    // checks the filter and the shape budget, name may be NULL
+    bool acceptVisualization(const char *name);
+    int maxShapes() const { return m_maxShapes; }
+    int droppedShapes() const { return m_droppedShapes; }
 
 signals:
     // wrapper may listen to reload request, but doesn't have to
@@ -84,6 +93,13 @@ protected:
 
     QString m_errorMsg;
     amun::DebugValues m_debug;
+    StrategyProfiler *m_profiler = nullptr;
+
+private:
+    QSet<QByteArray> m_hiddenVisualizations;
+    int m_maxShapes = 2000;
+    int m_shapeCount = 0;
+    int m_droppedShapes = 0;
 };
 
 #endif // ABSTRACTSTRATEGYSCRIPT_H
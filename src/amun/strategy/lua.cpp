@@ -24,6 +24,7 @@
 #include "lua_protobuf.h"
 #include "core/timer.h"
 #include "filewatcher.h"
+#include "strategyprofiler.h"
 
 Lua *getStrategyThread(lua_State *state)
 {
@@ -236,6 +237,32 @@ static int luaErrorHandler(lua_State* state)
     return 1;
 }
 
+static void luaSampleStack(lua_State *state, StrategyProfiler *profiler)
+{
+    QDir* baseDir = getBaseDir(state);
+    QByteArray stack;
+    lua_Debug ar;
+    // walk stack starting at the currently running function
+    for (int level = 0; lua_getstack(state, level, &ar) != 0; ++level) {
+        lua_getinfo(state, "nS", &ar);
+
+        QByteArray frame = (ar.name) ? QByteArray(ar.name) : QByteArray("?");
+        if (qstrcmp(ar.what, "C") == 0) {
+            frame += " [C]";
+        } else {
+            frame += " (" + extractFilename(ar.source, baseDir).toUtf8() + ":" + QByteArray::number(ar.linedefined) + ")";
+        }
+        // semicolons separate the frames
+        frame.replace(';', ':');
+
+        if (!stack.isEmpty()) {
+            frame += ';';
+        }
+        stack.prepend(frame);
+    }
+    profiler->addSample(stack);
+}
+
 static void luaDebugHook(lua_State *state, lua_Debug *ar)
 {
     const qint64 currentTime = Timer::systemTime();
@@ -245,11 +272,19 @@ static void luaDebugHook(lua_State *state, lua_Debug *ar)
     case LUA_HOOKTAILRET:
         break;
     case LUA_HOOKCOUNT:
-        if (currentTime - getStrategyThread(state)->startTime() > 0.5 * 1E9) {
+    {
+        Lua *thread = getStrategyThread(state);
+        if (currentTime - thread->startTime() > 0.5 * 1E9) {
             luaL_error(state, "Script timeout!");
         }
+        // the hook is called more often while profiling, sample once per interval
+        StrategyProfiler *profiler = thread->profiler();
+        if (profiler && profiler->isEnabled() && profiler->isDue(currentTime)) {
+            luaSampleStack(state, profiler);
+        }
         break;
     }
+    }
 }
 
 static void luaKillHook(lua_State *state, lua_Debug */*ar*/)
@@ -267,7 +302,9 @@ Lua::Lua(const Timer *timer, StrategyType type, bool debugEnabled, bool refboxCo
     m_timer(timer),
     m_type(type),
     m_debugEnabled(debugEnabled),
-    m_refboxControlEnabled(refboxControlEnabled)
+    m_refboxControlEnabled(refboxControlEnabled),
+    m_hookCount(1000000),
+    m_lastBudgetWarning(0)
 {
     // create lua instance and load libraries
     m_state = luaL_newstate();
@@ -282,7 +319,7 @@ Lua::Lua(const Timer *timer, StrategyType type, bool debugEnabled, bool refboxCo
     connect(m_watcher, SIGNAL(fileChanged(QString)), SIGNAL(requestReload()));
 
     // timeout hook
-    lua_sethook(m_state, luaDebugHook, LUA_MASKCOUNT, 1000000);
+    lua_sethook(m_state, luaDebugHook, LUA_MASKCOUNT, m_hookCount);
 
     // setup c registry fields
     lua_newtable(m_state);
@@ -377,6 +414,17 @@ bool Lua::process(double &pathPlanning, const world::State &worldState, const am
     // used to check for script timeout
     m_startTime = Timer::systemTime();
 
+    // profiling can be toggled at any time, adjust how often the hook is called
+    const bool profiling = m_profiler && m_profiler->isEnabled();
+    const int hookCount = (profiling) ? m_profiler->hookCount() : 1000000;
+    if (hookCount != m_hookCount) {
+        m_hookCount = hookCount;
+        lua_sethook(m_state, luaDebugHook, LUA_MASKCOUNT, m_hookCount);
+    }
+    if (profiling) {
+        m_profiler->beginFrame(m_startTime);
+    }
+
     // reset path planning time
     lua_pushnumber(m_state, 0);
     lua_setfield(m_state, LUA_REGISTRYINDEX, "PathPlanning");
@@ -388,6 +436,17 @@ bool Lua::process(double &pathPlanning, const world::State &worldState, const am
         return false;
     }
 
+    if (profiling) {
+        m_profiler->endFrame(&m_debug);
+    }
+
+    // dropping usually happens every frame, don't flood the log
+    if (droppedShapes() > 0 && m_startTime - m_lastBudgetWarning >= 1E9) {
+        m_lastBudgetWarning = m_startTime;
+        log(QString("<font color=\"red\">Visualization budget of %1 shapes exceeded, dropped %2 shapes</font>")
+            .arg(maxShapes()).arg(droppedShapes()));
+    }
+
     // collect timing information
     lua_getfield(m_state, LUA_REGISTRYINDEX, "PathPlanning");
     pathPlanning = lua_tonumber(m_state, -1);
@@ -423,8 +482,11 @@ void Lua::log(const QString &text)
     log->set_text(text.toStdString());
 }
 
-amun::Visualization *Lua::addVisualization()
+amun::Visualization *Lua::addVisualization(const char *name)
 {
+    if (!acceptVisualization(name)) {
+        return NULL;
+    }
     return m_debug.add_visualization();
 }
 
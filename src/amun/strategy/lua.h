@@ -54,13 +54,15 @@ public:
     amun::GameState refereeState() const { return m_refereeState; }
     amun::UserInput userInput() const { return m_userInput; }
     qint64 startTime() const { return m_startTime; }
+    StrategyProfiler *profiler() const { return m_profiler; }
     qint64 time() const;
     bool isBlue() const { return m_type == StrategyType::BLUE; }
     const QDir baseDir() const { return m_baseDir; }
     const bool refboxControlEnabled() const { return m_refboxControlEnabled; }
     void setCommand(uint generation, uint robotId, robot::Command &command);
     void log(const QString &text);
-    amun::Visualization *addVisualization();
+    // returns NULL if the visualization is disabled or the shape budget is exhausted
+    amun::Visualization *addVisualization(const char *name);
     amun::DebugValue *addDebug();
     amun::PlotValue *addPlot();
     bool sendCommand(const Command &command);
@@ -81,10 +83,12 @@ private:
     const StrategyType m_type;
     const bool m_debugEnabled;
     const bool m_refboxControlEnabled;
+    int m_hookCount;
 
     QString m_filename;
     QDir m_baseDir;
     qint64 m_startTime;
+    qint64 m_lastBudgetWarning;
 
     world::Geometry m_geometry;
     robot::Team m_team;
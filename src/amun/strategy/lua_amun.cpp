@@ -144,8 +144,14 @@ static int amunLog(lua_State *state)
 static int amunAddVisualization(lua_State *state)
 {
     Lua *thread = getStrategyThread(state);
-    amun::Visualization *vis = thread->addVisualization();
-    protobufToMessage(state, 1, *vis);
+    luaL_checktype(state, 1, LUA_TTABLE);
+    // check the name first, disabled visualizations are never converted
+    lua_getfield(state, 1, "name");
+    amun::Visualization *vis = thread->addVisualization(lua_tostring(state, -1));
+    lua_pop(state, 1);
+    if (vis) {
+        protobufToMessage(state, 1, *vis);
+    }
     return 0;
 }
 
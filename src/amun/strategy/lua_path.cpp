@@ -249,7 +249,10 @@ static void drawTree(Lua *thread, const KdTree *tree) {
     amun::Point *point;
     // draw tree by creating lines from every node to its predecessor
     foreach (const KdTree::Node *node, nodes) {
-        amun::Visualization *vis = thread->addVisualization();
+        amun::Visualization *vis = thread->addVisualization("RRT");
+        if (!vis) {
+            return;
+        }
         vis->set_name("RRT");
         amun::Pen *pen = vis->mutable_pen();
         pen->mutable_color()->set_red(255);
@@ -20,7 +20,9 @@
 
 #include "lua.h"
 #include "strategy.h"
+#include "strategyloader.h"
 #include "core/timer.h"
+#include "protobuf/configversion.h"
 #include "protobuf/geometry.h"
 #include <QDateTime>
 #include <QFileInfo>
@@ -42,6 +44,8 @@
 Strategy::Strategy(const Timer *timer, StrategyType type) :
     m_timer(timer),
     m_strategy(NULL),
+    m_loader(NULL),
+    m_reloadPending(false),
     m_type(type),
     m_debugEnabled(false),
     m_refboxControlEnabled(false),
@@ -66,7 +70,8 @@ Strategy::Strategy(const Timer *timer, StrategyType type) :
 
     // initialize geometry
     geometrySetDefault(&m_geometry);
-    m_geometryString = m_geometry.SerializeAsString();
+    m_geometryHash = messageHash(m_geometry);
+    m_teamHash = messageHash(m_team);
 }
 
 Strategy::~Strategy()
@@ -77,10 +82,12 @@ Strategy::~Strategy()
 void Strategy::handleStatus(const Status &status)
 {
     if (status->has_geometry()) {
-        const std::string str = status->geometry().SerializeAsString();
+        // geometry sent by the tracker is always versioned
+        const quint64 hash = status->has_geometry_version() ?
+                    status->geometry_version().hash() : messageHash(status->geometry());
         // reload only if geometry has changed
-        if (str != m_geometryString) {
-            m_geometryString = str;
+        if (hash != m_geometryHash) {
+            m_geometryHash = hash;
             m_geometry = status->geometry();
             reload();
         }
@@ -115,15 +122,11 @@ void Strategy::handleCommand(const Command &command)
 
     // update team robots, but only if something has changed
     if (m_type == StrategyType::BLUE && command->has_set_team_blue()) {
-        if (command->set_team_blue().SerializeAsString() != m_team.SerializeAsString()) {
-            m_team.CopyFrom(command->set_team_blue());
-            reloadStrategy = true;
-        }
+        reloadStrategy = updateTeam(command->set_team_blue(),
+                                    command->has_team_blue_version() ? &command->team_blue_version() : NULL);
     } else if (m_type == StrategyType::YELLOW && command->has_set_team_yellow()) {
-        if (command->set_team_yellow().SerializeAsString() != m_team.SerializeAsString()) {
-            m_team.CopyFrom(command->set_team_yellow());
-            reloadStrategy = true;
-        }
+        reloadStrategy = updateTeam(command->set_team_yellow(),
+                                    command->has_team_yellow_version() ? &command->team_yellow_version() : NULL);
     }
     // autoref has no robots
 
@@ -168,6 +171,28 @@ void Strategy::handleCommand(const Command &command)
             }
         }
 
+        if (cmd->has_visualizations()) {
+            // only affects the output, no reload required
+            m_visualizationFilter.CopyFrom(cmd->visualizations());
+            if (m_strategy) {
+                m_strategy->setVisualizationFilter(m_visualizationFilter);
+            }
+        }
+
+        if (cmd->has_profiler()) {
+            // the profiler is kept across reloads, thus no reload either
+            m_profiler.configure(cmd->profiler());
+            if (cmd->profiler().has_export_file()) {
+                const QString filename = QString::fromStdString(cmd->profiler().export_file());
+                QString error;
+                if (m_profiler.exportCollapsed(filename, &error)) {
+                    m_pendingLog.append(QString("Saved profile to %1").arg(filename));
+                } else {
+                    m_pendingLog.append(QString("<font color=\"red\">Failed to save profile to %1: %2</font>").arg(filename, error));
+                }
+            }
+        }
+
         if (cmd->has_load()) {
             const QString filename = QString::fromStdString(cmd->load().filename());
             QString entryPoint;
@@ -194,6 +219,18 @@ void Strategy::handleCommand(const Command &command)
     }
 }
 
+bool Strategy::updateTeam(const robot::Team &team, const world::ConfigVersion *version)
+{
+    // amun stamps every team, hashing is only required for unversioned commands
+    const quint64 hash = (version) ? version->hash() : messageHash(team);
+    if (hash == m_teamHash) {
+        return false;
+    }
+    m_teamHash = hash;
+    m_team.CopyFrom(team);
+    return true;
+}
+
 void Strategy::sendMixedTeamInfo(const QByteArray &data)
 {
     m_mixedTeamData = data;
@@ -267,6 +304,12 @@ void Strategy::process()
             timing->set_yellow_path(pathPlanning);
         }
         copyDebugValues(status);
+        foreach (const QString &text, m_pendingLog) {
+            amun::StatusLog *log = status->mutable_debug()->add_log();
+            log->set_timestamp(m_timer->currentTime());
+            log->set_text(text.toStdString());
+        }
+        m_pendingLog.clear();
         emit sendStatus(status);
     } else {
         fail(m_strategy->errorMsg());
@@ -275,6 +318,11 @@ void Strategy::process()
 
 void Strategy::reload()
 {
+    // load the file of the running load again once it has finished
+    if (m_loader) {
+        m_reloadPending = true;
+        return;
+    }
     if (!m_filename.isNull()) {
         loadScript(m_filename, m_entryPoint);
     }
@@ -289,39 +337,68 @@ void Strategy::sendCommand(const Command &command)
     }
 }
 
+AbstractStrategyScript *Strategy::createScript(const QString &filename)
+{
+    AbstractStrategyScript *script = NULL;
+    // hardcoded factory pattern
+    if (Lua::canHandle(filename)) {
+        script = Lua::createStrategy(m_timer, m_type, m_debugEnabled, m_refboxControlEnabled);
+    } else {
+        return NULL;
+    }
+
+    // delay reload until strategy is no longer running
+    connect(script, SIGNAL(requestReload()), SLOT(reload()), Qt::QueuedConnection);
+    // forward immediately
+    connect(script, SIGNAL(sendStrategyCommand(bool,unsigned int,unsigned int,QByteArray,qint64)),
+            SIGNAL(sendStrategyCommand(bool,unsigned int,unsigned int,QByteArray,qint64)));
+    connect(script, SIGNAL(gotCommand(Command)), SLOT(sendCommand(Command)));
+    connect(script, SIGNAL(sendMixedTeamInfo(QByteArray)), SLOT(sendMixedTeamInfo(QByteArray)));
+    connect(script, SIGNAL(sendNetworkRefereeCommand(QByteArray)), SLOT(sendNetworkRefereeCommand(QByteArray)));
+
+    script->setVisualizationFilter(m_visualizationFilter);
+    return script;
+}
+
 void Strategy::loadScript(const QString &filename, const QString &entryPoint)
 {
     Q_ASSERT(m_geometry.IsInitialized());
     Q_ASSERT(m_team.IsInitialized());
 
     m_reloadTimer->stop();
+    abortLoader();
+
+    // a working strategy keeps running while the new instance is loaded
+    // the filename is only replaced once the new instance is loaded successfully
+    if (m_strategy && !m_strategyFailed) {
+        AbstractStrategyScript *script = createScript(filename);
+        if (!script) {
+            fail(QString("No strategy handler for file %1").arg(filename));
+            return;
+        }
+        m_loader = new StrategyLoader(script, filename, entryPoint, m_geometry, m_team, this);
+        connect(m_loader, SIGNAL(finished()), SLOT(loaderFinished()));
+        m_loader->start();
+        return;
+    }
+
+    m_filename = filename;
+
     // use a fresh strategy instance when strategy is started
     delete m_strategy;
     m_strategy = NULL;
     m_strategyFailed = false;
 
-    m_filename = filename;
-
-    // hardcoded factory pattern
-    if (Lua::canHandle(filename)) {
-        m_strategy = Lua::createStrategy(m_timer, m_type, m_debugEnabled, m_refboxControlEnabled);
-    } else {
+    m_strategy = createScript(filename);
+    if (!m_strategy) {
         fail(QString("No strategy handler for file %1").arg(filename));
         return;
     }
 
-    // delay reload until strategy is no longer running
-    connect(m_strategy, SIGNAL(requestReload()), SLOT(reload()), Qt::QueuedConnection);
-    // forward immediately
-    connect(m_strategy, SIGNAL(sendStrategyCommand(bool,unsigned int,unsigned int,QByteArray,qint64)),
-            SIGNAL(sendStrategyCommand(bool,unsigned int,unsigned int,QByteArray,qint64)));
-    connect(m_strategy, SIGNAL(gotCommand(Command)), SLOT(sendCommand(Command)));
-    connect(m_strategy, SIGNAL(sendMixedTeamInfo(QByteArray)), SLOT(sendMixedTeamInfo(QByteArray)));
-    connect(m_strategy, SIGNAL(sendNetworkRefereeCommand(QByteArray)), SLOT(sendNetworkRefereeCommand(QByteArray)));
-
     if (m_strategy->loadScript(filename, entryPoint, m_geometry, m_team)) {
         m_entryPoint = m_strategy->entryPoint(); // remember loaded entrypoint
         m_strategy->setSelectedOptions(m_selectedOptions);
+        m_strategy->setProfiler(&m_profiler);
 
         // prepare strategy status message
         Status status(new amun::Status);
@@ -339,9 +416,71 @@ void Strategy::loadScript(const QString &filename, const QString &entryPoint)
     }
 }
 
+void Strategy::abortLoader()
+{
+    m_reloadPending = false;
+    if (!m_loader) {
+        return;
+    }
+    // the load can't be interrupted, drop the result once it's done
+    m_loader->disconnect(this);
+    connect(m_loader, SIGNAL(finished()), m_loader, SLOT(deleteLater()));
+    if (m_loader->isFinished()) {
+        m_loader->deleteLater();
+    }
+    m_loader = NULL;
+}
+
+void Strategy::loaderFinished()
+{
+    // a call queued before the loader was aborted may still arrive
+    if (m_loader == NULL || sender() != m_loader) {
+        return;
+    }
+
+    StrategyLoader *loader = m_loader;
+    m_loader = NULL;
+    loader->deleteLater();
+
+    // the script changed in the meantime, load it again
+    if (m_reloadPending) {
+        m_reloadPending = false;
+        loadScript(loader->filename(), loader->entryPoint());
+        return;
+    }
+
+    if (!loader->success()) {
+        // keep the old instance running
+        const QString error = loader->script()->errorMsg();
+        // the previous instance still watches the script files, so auto reload works as usual
+        m_pendingLog.append(QString("<font color=\"red\">Reload failed, keeping the previous instance!</font><br>") + error);
+        return;
+    }
+
+    delete m_strategy;
+    m_strategy = loader->takeScript();
+    m_strategyFailed = false;
+    m_filename = loader->filename();
+    m_entryPoint = m_strategy->entryPoint(); // remember loaded entrypoint
+    m_strategy->setSelectedOptions(m_selectedOptions);
+    m_strategy->setProfiler(&m_profiler);
+
+    Status status(new amun::Status);
+    setStrategyStatus(status, amun::StatusStrategy::RUNNING);
+    copyDebugValues(status);
+
+    amun::StatusLog *log = status->mutable_debug()->add_log();
+    log->set_timestamp(m_timer->currentTime());
+    log->set_text(QString("<font color=\"darkgreen\">Reloaded %1 with entry point %2 in %3 ms</font>")
+                  .arg(m_filename, m_entryPoint).arg(loader->duration() / 1E6, 0, 'f', 1).toStdString());
+
+    emit sendStatus(status);
+}
+
 void Strategy::close()
 {
     m_reloadTimer->stop();
+    abortLoader();
     if (m_type == StrategyType::BLUE || m_type == StrategyType::YELLOW) {
         emit sendHalt(m_type == StrategyType::BLUE);
     }
@@ -23,6 +23,7 @@
 
 #include "protobuf/command.h"
 #include "protobuf/status.h"
+#include "strategyprofiler.h"
 #include "strategytype.h"
 #include <QString>
 #include <QHostAddress>
@@ -31,6 +32,7 @@
 class QTimer;
 class Timer;
 class AbstractStrategyScript;
+class StrategyLoader;
 class QUdpSocket;
 
 class Strategy : public QObject
@@ -56,25 +58,38 @@ public slots:
 private slots:
     void process();
     void reload();
+    void loaderFinished();
     void sendCommand(const Command &command);
 
 private:
+    AbstractStrategyScript *createScript(const QString &filename);
     void loadScript(const QString &filename, const QString &entryPoint);
+    void abortLoader();
     void close();
     void fail(const QString &error);
     void setStrategyStatus(Status &status, amun::StatusStrategy::STATE state);
     void copyDebugValues(Status &status);
+    bool updateTeam(const robot::Team &team, const world::ConfigVersion *version);
     amun::DebugSource debugSource() const;
 
 private:
     const Timer *m_timer;
     AbstractStrategyScript *m_strategy;
-    std::string m_geometryString;
+    // replacement for m_strategy which is loaded in the background
+    StrategyLoader *m_loader;
+    bool m_reloadPending;
+    // stamped by the producers, only the hashes are compared
+    quint64 m_geometryHash;
+    quint64 m_teamHash;
     world::Geometry m_geometry;
     robot::Team m_team;
     Status m_status;
     const StrategyType m_type;
     QStringList m_selectedOptions;
+    amun::CommandStrategyVisualizations m_visualizationFilter;
+    StrategyProfiler m_profiler;
+    // messages for the strategy log, sent along with the next debug output
+    QStringList m_pendingLog;
 
     QString m_filename;
     QString m_entryPoint;
@@ -0,0 +1,70 @@
+/***************************************************************************
+ *   Copyright 2016 Robotics Erlangen e.V.                                 *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include "strategyloader.h"
+#include "abstractstrategyscript.h"
+#include "core/timer.h"
+
+/*!
+ * \class StrategyLoader
+ * \ingroup strategy
+ * \brief Loads a strategy script in the background
+ *
+ * The script is moved to the loader thread for the duration of the load
+ * and handed back to the thread which created the loader afterwards.
+ */
+
+StrategyLoader::StrategyLoader(AbstractStrategyScript *script, const QString &filename, const QString &entryPoint,
+                               const world::Geometry &geometry, const robot::Team &team, QObject *parent) :
+    QThread(parent),
+    m_script(script),
+    m_filename(filename),
+    m_entryPoint(entryPoint),
+    m_target(QThread::currentThread()),
+    m_success(false),
+    m_duration(0)
+{
+    m_geometry.CopyFrom(geometry);
+    m_team.CopyFrom(team);
+    m_script->moveToThread(this);
+}
+
+StrategyLoader::~StrategyLoader()
+{
+    wait();
+    delete m_script;
+}
+
+AbstractStrategyScript *StrategyLoader::takeScript()
+{
+    Q_ASSERT(isFinished());
+    AbstractStrategyScript *script = m_script;
+    m_script = NULL;
+    return script;
+}
+
+void StrategyLoader::run()
+{
+    const qint64 startTime = Timer::systemTime();
+    m_success = m_script->loadScript(m_filename, m_entryPoint, m_geometry, m_team);
+    m_duration = Timer::systemTime() - startTime;
+    // must be called from the thread the script currently belongs to
+    m_script->moveToThread(m_target);
+}
@@ -0,0 +1,63 @@
+/***************************************************************************
+ *   Copyright 2016 Robotics Erlangen e.V.                                 *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef STRATEGYLOADER_H
+#define STRATEGYLOADER_H
+
+#include "protobuf/robot.pb.h"
+#include "protobuf/world.pb.h"
+#include <QString>
+#include <QThread>
+
+class AbstractStrategyScript;
+
+// runs loadScript of a fresh strategy instance on its own thread
+class StrategyLoader : public QThread
+{
+    Q_OBJECT
+public:
+    StrategyLoader(AbstractStrategyScript *script, const QString &filename, const QString &entryPoint,
+                   const world::Geometry &geometry, const robot::Team &team, QObject *parent = 0);
+    ~StrategyLoader() override;
+
+public:
+    // only valid after the thread has finished, the script is deleted with the loader unless taken
+    AbstractStrategyScript *script() const { return m_script; }
+    AbstractStrategyScript *takeScript();
+    bool success() const { return m_success; }
+    const QString &filename() const { return m_filename; }
+    const QString &entryPoint() const { return m_entryPoint; }
+    qint64 duration() const { return m_duration; }
+
+protected:
+    void run() override;
+
+private:
+    AbstractStrategyScript *m_script;
+    const QString m_filename;
+    const QString m_entryPoint;
+    world::Geometry m_geometry;
+    robot::Team m_team;
+    QThread *m_target;
+    bool m_success;
+    qint64 m_duration;
+};
+
+#endif // STRATEGYLOADER_H
@@ -0,0 +1,122 @@
+/***************************************************************************
+ *   Copyright 2016 Robotics Erlangen e.V.                                 *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include "strategyprofiler.h"
+#include "protobuf/debug.pb.h"
+#include <QFile>
+#include <algorithm>
+
+StrategyProfiler::StrategyProfiler() :
+    m_enabled(false),
+    m_interval(1000000),
+    m_nextSample(0)
+{ }
+
+void StrategyProfiler::configure(const amun::CommandStrategyProfiler &command)
+{
+    if (command.has_enable()) {
+        m_enabled = command.enable();
+    }
+    if (command.has_rate() && command.rate() > 0) {
+        m_interval = 1000000000LL / command.rate();
+    }
+    if (command.reset()) {
+        reset();
+    }
+}
+
+void StrategyProfiler::beginFrame(qint64 time)
+{
+    m_frameSamples.clear();
+    m_nextSample = time + m_interval;
+}
+
+bool StrategyProfiler::isDue(qint64 time)
+{
+    if (time < m_nextSample) {
+        return false;
+    }
+    // don't try to catch up on missed samples, that would only bias the result
+    m_nextSample = time + m_interval;
+    return true;
+}
+
+void StrategyProfiler::addSample(const QByteArray &stack)
+{
+    m_frameSamples[stack]++;
+    m_sessionSamples[stack]++;
+}
+
+void StrategyProfiler::endFrame(amun::DebugValues *debug) const
+{
+    int samples = 0;
+    int hottestCount = 0;
+    QHash<QByteArray, int> leafs;
+    for (QHash<QByteArray, int>::const_iterator it = m_frameSamples.constBegin(); it != m_frameSamples.constEnd(); ++it) {
+        samples += it.value();
+        const QByteArray leaf = it.key().mid(it.key().lastIndexOf(';') + 1);
+        hottestCount = std::max(hottestCount, leafs[leaf] += it.value());
+    }
+
+    amun::DebugValue *value = debug->add_value();
+    value->set_key("Profiler/Samples");
+    value->set_float_value(samples);
+
+    value = debug->add_value();
+    value->set_key("Profiler/Hottest");
+    if (samples == 0) {
+        value->set_string_value("<none>");
+    } else {
+        const QByteArray hottest = leafs.key(hottestCount);
+        value->set_string_value(QString("%1 (%2%)").arg(QString::fromUtf8(hottest))
+                                .arg(100 * hottestCount / samples).toStdString());
+    }
+}
+
+void StrategyProfiler::reset()
+{
+    m_frameSamples.clear();
+    m_sessionSamples.clear();
+}
+
+bool StrategyProfiler::exportCollapsed(const QString &filename, QString *error) const
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        *error = file.errorString();
+        return false;
+    }
+
+    // one line per stack, as expected by flamegraph.pl
+    QList<QByteArray> stacks = m_sessionSamples.keys();
+    std::sort(stacks.begin(), stacks.end());
+    foreach (const QByteArray &stack, stacks) {
+        file.write(stack);
+        file.write(" ");
+        file.write(QByteArray::number(m_sessionSamples.value(stack)));
+        file.write("\n");
+    }
+
+    if (file.error() != QFile::NoError) {
+        *error = file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,59 @@
+/***************************************************************************
+ *   Copyright 2016 Robotics Erlangen e.V.                                 *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef STRATEGYPROFILER_H
+#define STRATEGYPROFILER_H
+
+#include "protobuf/command.h"
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+namespace amun { class DebugValues; }
+
+// aggregates sampled call stacks, a stack is a list of frames separated by ';' starting at the root
+class StrategyProfiler
+{
+public:
+    StrategyProfiler();
+
+public:
+    void configure(const amun::CommandStrategyProfiler &command);
+    bool isEnabled() const { return m_enabled; }
+    // number of vm instructions between checks whether a sample is due
+    int hookCount() const { return 1000; }
+
+    void beginFrame(qint64 time);
+    bool isDue(qint64 time);
+    void addSample(const QByteArray &stack);
+    void endFrame(amun::DebugValues *debug) const;
+
+    void reset();
+    bool exportCollapsed(const QString &filename, QString *error) const;
+
+private:
+    bool m_enabled;
+    qint64 m_interval;
+    qint64 m_nextSample;
+    QHash<QByteArray, int> m_frameSamples;
+    QHash<QByteArray, qint64> m_sessionSamples;
+};
+
+#endif // STRATEGYPROFILER_H
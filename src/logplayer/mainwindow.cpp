@@ -50,6 +50,8 @@ MainWindow::MainWindow(QWidget *parent) :
     m_logreader->moveToThread(m_logthread);
     connect(m_logreader, SIGNAL(gotStatus(int,Status)), this, SLOT(addStatus(int,Status)));
     connect(this, SIGNAL(triggerRead(int,int)), m_logreader, SLOT(readPackets(int,int)));
+    connect(m_logreader, SIGNAL(gotState(int,Status)), this, SLOT(addState(int,Status)));
+    connect(this, SIGNAL(triggerSeek(int,int,int)), m_logreader, SLOT(seekPacket(int,int,int)));
 
     m_plotter = new Plotter();
 
@@ -307,18 +309,42 @@ void MainWindow::seekPacket(int packet)
         return;
     }
 
-    // read a few packets before the new one to have a complete up-to-date status
-    // except if we just move to the next packet
-    int preloadCount = (packet == m_nextRequestPacket) ? 1 : 10;
-    const int preloadPacket = std::max(0, packet - preloadCount + 1);
-    preloadCount = packet - preloadPacket + 1; // allow playback of the first frames
-
-    // fast forward unwanted packets and the preload
-    m_spoolCounter += preloadCount + m_preloadedPackets; // playback without time checks
+    // fast forward the already requested packets
+    m_spoolCounter += 1 + m_preloadedPackets; // playback without time checks
     m_preloadedPackets = 0; // the preloaded frames for normal playback are skipped
+
+    if (packet == m_nextRequestPacket) {
+        // just move to the next packet
+        m_nextRequestPacket = packet + 1;
+        emit triggerRead(packet, 1);
+        return;
+    }
+
+    // the reader accumulates the state before the packet and only emits that state,
+    // newer logs contain keyframes with the accumulated state up to their packet
+    int keyframe = m_logreader->findKeyframe(packet);
+    int startPacket;
+    if (keyframe >= 0 && packet > m_nextRequestPacket && m_logreader->keyframePacket(keyframe) <= m_nextRequestPacket) {
+        // seeking forward in the same keyframe interval, the packets read so far
+        // already include the keyframe, thus just continue from the current position
+        startPacket = m_nextRequestPacket;
+        keyframe = -1;
+    } else if (keyframe >= 0) {
+        startPacket = m_logreader->keyframePacket(keyframe);
+    } else {
+        // use a few packets before the new one to have a complete up-to-date status
+        startPacket = std::max(0, packet - 9);
+    }
     m_nextRequestPacket = packet + 1;
 
-    emit triggerRead(preloadPacket, preloadCount); // load the required packets
+    emit triggerSeek(keyframe, startPacket, packet);
+}
+
+void MainWindow::addState(int packet, const Status &status)
+{
+    // the accumulated state is played without time checks like the packet following it
+    m_spoolCounter++;
+    addStatus(packet, status);
 }
 
 void MainWindow::addStatus(int packet, const Status &status)
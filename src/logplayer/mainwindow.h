@@ -57,6 +57,7 @@ signals:
     void gotStatus(const Status &status);
     void gotPlayStatus(const Status &status); // guarantees a continuous data stream
     void triggerRead(int startFrame, int count);
+    void triggerSeek(int keyframe, int startPacket, int packet);
 
 private slots:
     void openFile();
@@ -65,6 +66,7 @@ private slots:
     void seekFrame(int frame);
     void seekPacket(int packet);
     void addStatus(int packet, const Status &status);
+    void addState(int packet, const Status &status);
     void playNext();
     void togglePaused();
     void handlePlaySpeed(int value);
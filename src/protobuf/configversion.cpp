@@ -0,0 +1,49 @@
+/***************************************************************************
+ *   Copyright 2016 Robotics Erlangen e.V.                                 *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include "configversion.h"
+#include <google/protobuf/message.h>
+
+/*!
+ * \brief 64 bit FNV-1a hash of the serialized message
+ *
+ * Only meant to be evaluated by the producer of a message, consumers compare
+ * the resulting version instead of serializing the message themselves.
+ */
+uint64_t messageHash(const google::protobuf::Message &message)
+{
+    const std::string data = message.SerializeAsString();
+    uint64_t hash = UINT64_C(14695981039346656037);
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= UINT64_C(1099511628211);
+    }
+    return hash;
+}
+
+bool configVersionUpdate(world::ConfigVersion *version, const google::protobuf::Message &message)
+{
+    const uint64_t hash = messageHash(message);
+    if (version->has_hash() && version->hash() == hash) {
+        return false;
+    }
+    version->set_hash(hash);
+    return true;
+}
@@ -0,0 +1,33 @@
+/***************************************************************************
+ *   Copyright 2016 Robotics Erlangen e.V.                                 *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef CONFIGVERSION_H
+#define CONFIGVERSION_H
+
+#include "protobuf/world.pb.h"
+#include <cstdint>
+
+namespace google { namespace protobuf { class Message; } }
+
+uint64_t messageHash(const google::protobuf::Message &message);
+// updates the version if message differs from the last version, returns true in that case
+bool configVersionUpdate(world::ConfigVersion *version, const google::protobuf::Message &message);
+
+#endif // CONFIGVERSION_H
@@ -0,0 +1,517 @@
+/***************************************************************************
+ *   Copyright 2016 Robotics Erlangen e.V.                                 *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include "statusdelta.h"
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+using google::protobuf::RepeatedPtrField;
+
+static uint32_t floatBits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// the difference of the bit representation is small for similar values
+static int32_t floatDiff(float value, float last)
+{
+    return (int32_t)(floatBits(value) - floatBits(last));
+}
+
+static float floatApply(float last, int32_t diff)
+{
+    const uint32_t bits = floatBits(last) + (uint32_t)diff;
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+template<class Delta>
+static void setDiff(Delta *delta, void (Delta::*setter)(int32_t), float value, float last)
+{
+    // unchanged values are omitted
+    const int32_t diff = floatDiff(value, last);
+    if (diff != 0) {
+        (delta->*setter)(diff);
+    }
+}
+
+static bool isEqual(float a, float b)
+{
+    // compare bitwise as the reconstruction must be exact
+    return floatBits(a) == floatBits(b);
+}
+
+static bool isEqual(const amun::Color &a, const amun::Color &b)
+{
+    return a.has_red() == b.has_red() && a.red() == b.red()
+            && a.has_green() == b.has_green() && a.green() == b.green()
+            && a.has_blue() == b.has_blue() && a.blue() == b.blue()
+            && a.has_alpha() == b.has_alpha() && a.alpha() == b.alpha();
+}
+
+static bool isEqual(const RepeatedPtrField<amun::Point> &a, const RepeatedPtrField<amun::Point> &b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (int i = 0; i < a.size(); ++i) {
+        if (!isEqual(a.Get(i).x(), b.Get(i).x()) || !isEqual(a.Get(i).y(), b.Get(i).y())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool isEqual(const amun::DebugValue &a, const amun::DebugValue &b)
+{
+    return a.key() == b.key()
+            && a.has_float_value() == b.has_float_value() && isEqual(a.float_value(), b.float_value())
+            && a.has_bool_value() == b.has_bool_value() && a.bool_value() == b.bool_value()
+            && a.has_string_value() == b.has_string_value() && a.string_value() == b.string_value();
+}
+
+static bool isEqual(const amun::Visualization &a, const amun::Visualization &b)
+{
+    if (a.name() != b.name()
+            || a.has_pen() != b.has_pen()
+            || a.has_brush() != b.has_brush()
+            || a.has_width() != b.has_width()
+            || a.has_circle() != b.has_circle()
+            || a.has_polygon() != b.has_polygon()
+            || a.has_path() != b.has_path()
+            || a.has_background() != b.has_background() || a.background() != b.background()) {
+        return false;
+    }
+    if (a.has_pen()) {
+        const amun::Pen &penA = a.pen();
+        const amun::Pen &penB = b.pen();
+        if (penA.has_style() != penB.has_style() || penA.style() != penB.style()
+                || penA.has_color() != penB.has_color() || !isEqual(penA.color(), penB.color())) {
+            return false;
+        }
+    }
+    if (a.has_brush() && !isEqual(a.brush(), b.brush())) {
+        return false;
+    }
+    if (a.has_width() && !isEqual(a.width(), b.width())) {
+        return false;
+    }
+    if (a.has_circle()) {
+        const amun::Circle &circleA = a.circle();
+        const amun::Circle &circleB = b.circle();
+        if (!isEqual(circleA.p_x(), circleB.p_x()) || !isEqual(circleA.p_y(), circleB.p_y())
+                || !isEqual(circleA.radius(), circleB.radius())) {
+            return false;
+        }
+    }
+    if (a.has_polygon() && !isEqual(a.polygon().point(), b.polygon().point())) {
+        return false;
+    }
+    if (a.has_path() && !isEqual(a.path().point(), b.path().point())) {
+        return false;
+    }
+    return true;
+}
+
+static const std::string &deltaKey(const amun::DebugValue &value)
+{
+    return value.key();
+}
+
+static const std::string &deltaKey(const amun::Visualization &vis)
+{
+    return vis.name();
+}
+
+/*!
+ * \brief Encode a repeated field as ranges of unchanged entries and new entries
+ *
+ * Entries are expected to mostly keep their order. Thus the entry following
+ * the last match is checked first, the key lookup is only built if the order
+ * changed.
+ */
+template<class T>
+static void encodeSpans(const RepeatedPtrField<T> &last, const RepeatedPtrField<T> &current,
+                        RepeatedPtrField<amun::DeltaSpan> *spans, RepeatedPtrField<T> *added)
+{
+    std::unordered_multimap<std::string, int> lookup;
+    bool hasLookup = false;
+    int expected = 0;
+    amun::DeltaSpan *span = NULL;
+
+    for (int i = 0; i < current.size(); ++i) {
+        const T &entry = current.Get(i);
+
+        int match = -1;
+        if (expected < last.size() && isEqual(last.Get(expected), entry)) {
+            match = expected;
+        } else if (last.size() > 0) {
+            if (!hasLookup) {
+                for (int j = 0; j < last.size(); ++j) {
+                    lookup.insert(std::make_pair(deltaKey(last.Get(j)), j));
+                }
+                hasLookup = true;
+            }
+            // keys aren't unique, e.g. visualizations often share their name
+            auto range = lookup.equal_range(deltaKey(entry));
+            for (auto it = range.first; it != range.second; ++it) {
+                if (isEqual(last.Get(it->second), entry)) {
+                    match = it->second;
+                    break;
+                }
+            }
+        }
+
+        if (match >= 0) {
+            if (span && span->has_copy_start() && (int)(span->copy_start() + span->count()) == match) {
+                span->set_count(span->count() + 1);
+            } else {
+                span = spans->Add();
+                span->set_copy_start(match);
+                span->set_count(1);
+            }
+            expected = match + 1;
+        } else {
+            added->Add()->CopyFrom(entry);
+            if (span && !span->has_copy_start()) {
+                span->set_count(span->count() + 1);
+            } else {
+                span = spans->Add();
+                span->set_count(1);
+            }
+        }
+    }
+}
+
+template<class T>
+static bool decodeSpans(const RepeatedPtrField<T> &last, const RepeatedPtrField<amun::DeltaSpan> &spans,
+                        const RepeatedPtrField<T> &added, RepeatedPtrField<T> *result)
+{
+    result->Clear();
+    int nextAdded = 0;
+    for (const amun::DeltaSpan &span: spans) {
+        const int count = span.count();
+        if (span.has_copy_start()) {
+            const int start = span.copy_start();
+            if (start + count > last.size()) {
+                return false;
+            }
+            for (int i = start; i < start + count; ++i) {
+                result->Add()->CopyFrom(last.Get(i));
+            }
+        } else {
+            if (nextAdded + count > added.size()) {
+                return false;
+            }
+            for (int i = nextAdded; i < nextAdded + count; ++i) {
+                result->Add()->CopyFrom(added.Get(i));
+            }
+            nextAdded += count;
+        }
+    }
+    return nextAdded == added.size();
+}
+
+static void encodeDebug(const amun::DebugValues &last, const amun::DebugValues &debug, amun::DebugValuesDelta *delta)
+{
+    delta->set_source(debug.source());
+    encodeSpans(last.value(), debug.value(), delta->mutable_value_span(), delta->mutable_value());
+    encodeSpans(last.visualization(), debug.visualization(), delta->mutable_visualization_span(),
+                delta->mutable_visualization());
+    // log and plot entries are new in every frame
+    delta->mutable_log()->CopyFrom(debug.log());
+    delta->mutable_plot()->CopyFrom(debug.plot());
+}
+
+static bool decodeDebug(const amun::DebugValues &last, const amun::DebugValuesDelta &delta, amun::DebugValues *debug)
+{
+    debug->set_source(delta.source());
+    if (!decodeSpans(last.value(), delta.value_span(), delta.value(), debug->mutable_value())) {
+        return false;
+    }
+    if (!decodeSpans(last.visualization(), delta.visualization_span(), delta.visualization(),
+                     debug->mutable_visualization())) {
+        return false;
+    }
+    debug->mutable_log()->CopyFrom(delta.log());
+    debug->mutable_plot()->CopyFrom(delta.plot());
+    return true;
+}
+
+static const world::Robot *findRobot(const RepeatedPtrField<world::Robot> &robots, uint32_t id, int hint)
+{
+    // robots usually keep their position in the list
+    if (hint < robots.size() && robots.Get(hint).id() == id) {
+        return &robots.Get(hint);
+    }
+    for (const world::Robot &robot: robots) {
+        if (robot.id() == id) {
+            return &robot;
+        }
+    }
+    return NULL;
+}
+
+static void encodeRobots(const RepeatedPtrField<world::Robot> &last, const RepeatedPtrField<world::Robot> &robots,
+                         RepeatedPtrField<world::RobotDelta> *deltas)
+{
+    for (int i = 0; i < robots.size(); ++i) {
+        const world::Robot &robot = robots.Get(i);
+        world::RobotDelta *delta = deltas->Add();
+        delta->set_id(robot.id());
+
+        const world::Robot *lastRobot = findRobot(last, robot.id(), i);
+        if (!lastRobot) {
+            delta->mutable_robot()->CopyFrom(robot);
+            continue;
+        }
+
+        setDiff(delta, &world::RobotDelta::set_p_x, robot.p_x(), lastRobot->p_x());
+        setDiff(delta, &world::RobotDelta::set_p_y, robot.p_y(), lastRobot->p_y());
+        setDiff(delta, &world::RobotDelta::set_phi, robot.phi(), lastRobot->phi());
+        setDiff(delta, &world::RobotDelta::set_v_x, robot.v_x(), lastRobot->v_x());
+        setDiff(delta, &world::RobotDelta::set_v_y, robot.v_y(), lastRobot->v_y());
+        setDiff(delta, &world::RobotDelta::set_omega, robot.omega(), lastRobot->omega());
+        delta->mutable_raw()->CopyFrom(robot.raw());
+    }
+}
+
+static bool decodeRobots(const RepeatedPtrField<world::Robot> &last, const RepeatedPtrField<world::RobotDelta> &deltas,
+                         RepeatedPtrField<world::Robot> *robots)
+{
+    robots->Clear();
+    for (int i = 0; i < deltas.size(); ++i) {
+        const world::RobotDelta &delta = deltas.Get(i);
+        world::Robot *robot = robots->Add();
+        if (delta.has_robot()) {
+            robot->CopyFrom(delta.robot());
+            continue;
+        }
+
+        const world::Robot *lastRobot = findRobot(last, delta.id(), i);
+        if (!lastRobot) {
+            return false;
+        }
+        robot->set_id(delta.id());
+        robot->set_p_x(floatApply(lastRobot->p_x(), delta.p_x()));
+        robot->set_p_y(floatApply(lastRobot->p_y(), delta.p_y()));
+        robot->set_phi(floatApply(lastRobot->phi(), delta.phi()));
+        robot->set_v_x(floatApply(lastRobot->v_x(), delta.v_x()));
+        robot->set_v_y(floatApply(lastRobot->v_y(), delta.v_y()));
+        robot->set_omega(floatApply(lastRobot->omega(), delta.omega()));
+        robot->mutable_raw()->CopyFrom(delta.raw());
+    }
+    return true;
+}
+
+static void encodeState(const world::State &last, const world::State &state, world::StateDelta *delta)
+{
+    delta->set_time(state.time() - last.time());
+
+    if (state.has_ball()) {
+        const world::Ball &ball = state.ball();
+        const world::Ball &lastBall = last.ball();
+        if (last.has_ball() && lastBall.has_p_z() == ball.has_p_z() && lastBall.has_v_z() == ball.has_v_z()) {
+            world::BallDelta *ballDelta = delta->mutable_ball_delta();
+            setDiff(ballDelta, &world::BallDelta::set_p_x, ball.p_x(), lastBall.p_x());
+            setDiff(ballDelta, &world::BallDelta::set_p_y, ball.p_y(), lastBall.p_y());
+            setDiff(ballDelta, &world::BallDelta::set_v_x, ball.v_x(), lastBall.v_x());
+            setDiff(ballDelta, &world::BallDelta::set_v_y, ball.v_y(), lastBall.v_y());
+            if (ball.has_p_z()) {
+                setDiff(ballDelta, &world::BallDelta::set_p_z, ball.p_z(), lastBall.p_z());
+            }
+            if (ball.has_v_z()) {
+                setDiff(ballDelta, &world::BallDelta::set_v_z, ball.v_z(), lastBall.v_z());
+            }
+            ballDelta->mutable_raw()->CopyFrom(ball.raw());
+        } else {
+            delta->mutable_ball()->CopyFrom(ball);
+        }
+    }
+
+    encodeRobots(last.yellow(), state.yellow(), delta->mutable_yellow());
+    encodeRobots(last.blue(), state.blue(), delta->mutable_blue());
+
+    delta->mutable_radio_response()->CopyFrom(state.radio_response());
+    if (state.has_is_simulated()) {
+        delta->set_is_simulated(state.is_simulated());
+    }
+    if (state.has_has_vision_data()) {
+        delta->set_has_vision_data(state.has_vision_data());
+    }
+    if (state.has_mixed_team_info()) {
+        delta->mutable_mixed_team_info()->CopyFrom(state.mixed_team_info());
+    }
+}
+
+static bool decodeState(const world::State &last, const world::StateDelta &delta, world::State *state)
+{
+    state->Clear();
+    state->set_time(last.time() + delta.time());
+
+    if (delta.has_ball()) {
+        state->mutable_ball()->CopyFrom(delta.ball());
+    } else if (delta.has_ball_delta()) {
+        if (!last.has_ball()) {
+            return false;
+        }
+        const world::BallDelta &ballDelta = delta.ball_delta();
+        const world::Ball &lastBall = last.ball();
+        world::Ball *ball = state->mutable_ball();
+        ball->set_p_x(floatApply(lastBall.p_x(), ballDelta.p_x()));
+        ball->set_p_y(floatApply(lastBall.p_y(), ballDelta.p_y()));
+        ball->set_v_x(floatApply(lastBall.v_x(), ballDelta.v_x()));
+        ball->set_v_y(floatApply(lastBall.v_y(), ballDelta.v_y()));
+        if (lastBall.has_p_z()) {
+            ball->set_p_z(floatApply(lastBall.p_z(), ballDelta.p_z()));
+        }
+        if (lastBall.has_v_z()) {
+            ball->set_v_z(floatApply(lastBall.v_z(), ballDelta.v_z()));
+        }
+        ball->mutable_raw()->CopyFrom(ballDelta.raw());
+    }
+
+    if (!decodeRobots(last.yellow(), delta.yellow(), state->mutable_yellow())
+            || !decodeRobots(last.blue(), delta.blue(), state->mutable_blue())) {
+        return false;
+    }
+
+    state->mutable_radio_response()->CopyFrom(delta.radio_response());
+    if (delta.has_is_simulated()) {
+        state->set_is_simulated(delta.is_simulated());
+    }
+    if (delta.has_has_vision_data()) {
+        state->set_has_vision_data(delta.has_vision_data());
+    }
+    if (delta.has_mixed_team_info()) {
+        state->mutable_mixed_team_info()->CopyFrom(delta.mixed_team_info());
+    }
+    return true;
+}
+
+/*!
+ * \class StatusDeltaEncoder
+ * \ingroup protobuf
+ * \brief Delta encoding for serialized status streams
+ *
+ * Robots and ball are encoded relative to the previous world state, debug
+ * values and visualizations which are identical to the previous frame of the
+ * same debug source are only referenced. A stream must be decoded in the order
+ * it was encoded, reset() starts a new self-contained stream.
+ */
+
+StatusDeltaEncoder::StatusDeltaEncoder() :
+    m_hasState(false)
+{
+}
+
+/*!
+ * \brief Forget the previous status, the next one is encoded completely
+ */
+void StatusDeltaEncoder::reset()
+{
+    m_state.Clear();
+    m_hasState = false;
+    m_debug.clear();
+}
+
+/*!
+ * \brief Encode a status
+ * \param status Status to encode
+ * \param encoded Copy of the status with world state and debug values replaced by their delta
+ */
+void StatusDeltaEncoder::encode(const amun::Status &status, amun::Status *encoded)
+{
+    encoded->CopyFrom(status);
+
+    if (status.has_world_state()) {
+        if (m_hasState) {
+            encodeState(m_state, status.world_state(), encoded->mutable_world_state_delta());
+            encoded->clear_world_state();
+        }
+        m_state.CopyFrom(status.world_state());
+        m_hasState = true;
+    }
+
+    if (status.has_debug()) {
+        // the first debug values of a source are encoded relative to an empty message
+        amun::DebugValues &last = m_debug[status.debug().source()];
+        encodeDebug(last, status.debug(), encoded->mutable_debug_delta());
+        encoded->clear_debug();
+        last.CopyFrom(status.debug());
+    }
+}
+
+/*!
+ * \class StatusDeltaDecoder
+ * \ingroup protobuf
+ * \brief Restores status encoded by a StatusDeltaEncoder
+ */
+
+StatusDeltaDecoder::StatusDeltaDecoder() :
+    m_hasState(false)
+{
+}
+
+/*!
+ * \brief Forget the previous status, must be called whenever the encoder was reset
+ */
+void StatusDeltaDecoder::reset()
+{
+    m_state.Clear();
+    m_hasState = false;
+    m_debug.clear();
+}
+
+/*!
+ * \brief Decode a status in place
+ * \param status Status to decode, status without deltas are left unchanged
+ * \return False if the status doesn't fit the previously decoded ones
+ */
+bool StatusDeltaDecoder::decode(amun::Status *status)
+{
+    if (status->has_world_state_delta()) {
+        if (!m_hasState || !decodeState(m_state, status->world_state_delta(), status->mutable_world_state())) {
+            return false;
+        }
+        status->clear_world_state_delta();
+    }
+    if (status->has_world_state()) {
+        m_state.CopyFrom(status->world_state());
+        m_hasState = true;
+    }
+
+    if (status->has_debug_delta()) {
+        const amun::DebugValuesDelta &delta = status->debug_delta();
+        amun::DebugValues &last = m_debug[delta.source()];
+        if (!decodeDebug(last, delta, status->mutable_debug())) {
+            return false;
+        }
+        status->clear_debug_delta();
+        last.CopyFrom(status->debug());
+    } else if (status->has_debug()) {
+        m_debug[status->debug().source()].CopyFrom(status->debug());
+    }
+    return true;
+}
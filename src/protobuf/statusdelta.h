@@ -0,0 +1,60 @@
+/***************************************************************************
+ *   Copyright 2016 Robotics Erlangen e.V.                                 *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef STATUSDELTA_H
+#define STATUSDELTA_H
+
+#include "protobuf/status.pb.h"
+#include <map>
+
+//! Replaces world state and debug values of a status stream by their
+//! difference to the previous status. The reconstruction is exact.
+class StatusDeltaEncoder
+{
+public:
+    StatusDeltaEncoder();
+
+public:
+    void reset();
+    void encode(const amun::Status &status, amun::Status *encoded);
+
+private:
+    world::State m_state;
+    bool m_hasState;
+    std::map<int, amun::DebugValues> m_debug;
+};
+
+//! Restores status encoded by a StatusDeltaEncoder
+class StatusDeltaDecoder
+{
+public:
+    StatusDeltaDecoder();
+
+public:
+    void reset();
+    bool decode(amun::Status *status);
+
+private:
+    world::State m_state;
+    bool m_hasState;
+    std::map<int, amun::DebugValues> m_debug;
+};
+
+#endif // STATUSDELTA_H
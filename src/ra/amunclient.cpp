@@ -20,12 +20,25 @@
 
 #include "amunclient.h"
 #include "amun/amun.h"
+#include <QLocalSocket>
+#include <QTcpSocket>
 #include <QThread>
+#include <QTimer>
+#include <QtEndian>
+
+// delay before trying to reconnect to a remote amun, in ms
+static const int RECONNECT_DELAY = 1000;
+// statuses queued for the gui thread, only reached if it stalls
+static const int INBOX_CAPACITY = 500;
+// minimal time between two queued states of the same kind, in ns
+static const qint64 INBOX_SAMPLE_INTERVAL = 10 * 1000 * 1000;
 
 AmunClient::AmunClient(QObject *parent) :
     QObject(parent),
     m_amun(NULL),
-    m_amunThread(NULL)
+    m_amunThread(NULL),
+    m_inbox(INBOX_CAPACITY, INBOX_SAMPLE_INTERVAL),
+    m_remote(NULL)
 {
 }
 
@@ -40,14 +53,152 @@ void AmunClient::start()
     m_amun = new Amun();
     m_amun->moveToThread(m_amunThread);
 
-    connect(m_amun, SIGNAL(sendStatus(Status)), SIGNAL(gotStatus(Status)));
+    // queue in the amun thread, instead of posting one event per status to the gui thread
+    connect(m_amun, SIGNAL(sendStatus(Status)), SLOT(queueStatus(Status)), Qt::DirectConnection);
+    connect(m_amun, SIGNAL(sendStatus(Status)), SIGNAL(gotStatusForLog(Status)), Qt::DirectConnection);
     connect(this, SIGNAL(sendCommand(Command)), m_amun, SLOT(handleCommand(Command)));
     m_amun->start();
     m_amunThread->start();
 }
 
+/*!
+ * \brief Queue a status of amun for the gui thread
+ *
+ * Called from the amun thread. Only a single delivery is pending at a time,
+ * statuses arriving in the meantime are coalesced by the inbox.
+ */
+void AmunClient::queueStatus(const Status &status)
+{
+    QMutexLocker locker(&m_inboxMutex);
+    const bool isDeliveryPending = !m_inbox.isEmpty();
+    m_inbox.push(status);
+    if (!isDeliveryPending) {
+        QMetaObject::invokeMethod(this, "deliverStatus", Qt::QueuedConnection);
+    }
+}
+
+void AmunClient::deliverStatus()
+{
+    m_inboxMutex.lock();
+    const QList<Status> states = m_inbox.take();
+    m_inboxMutex.unlock();
+
+    foreach (const Status &status, states) {
+        emit gotStatus(status);
+    }
+}
+
+//! Number of statuses replaced by a newer one before reaching the gui
+quint64 AmunClient::coalescedStatus()
+{
+    QMutexLocker locker(&m_inboxMutex);
+    return m_inbox.coalesced();
+}
+
+//! Number of statuses dropped as the gui didn't keep up
+quint64 AmunClient::droppedStatus()
+{
+    QMutexLocker locker(&m_inboxMutex);
+    return m_inbox.dropped();
+}
+
+/*!
+ * \brief Show the status stream of a remote amun instead of starting amun
+ *
+ * Commands are dropped as remote clients are only observers.
+ * \param address host:port for tcp or local:name for a local socket
+ * \param subscription the parts of the status to receive
+ */
+void AmunClient::startRemote(const QString &address, const amun::StatusSubscription &subscription)
+{
+    m_remoteAddress = address;
+    m_subscription = subscription;
+    connectRemote();
+}
+
+void AmunClient::connectRemote()
+{
+    m_buffer.clear();
+    m_decoder.reset();
+
+    if (m_remoteAddress.startsWith("local:")) {
+        QLocalSocket *socket = new QLocalSocket(this);
+        connect(socket, &QLocalSocket::connected, this, &AmunClient::sendSubscription);
+        connect(socket, &QLocalSocket::disconnected, this, &AmunClient::remoteDisconnected);
+        connect(socket, static_cast<void (QLocalSocket::*)(QLocalSocket::LocalSocketError)>(&QLocalSocket::error),
+                this, &AmunClient::remoteDisconnected);
+        m_remote = socket;
+        socket->connectToServer(m_remoteAddress.mid(6));
+    } else {
+        const int split = m_remoteAddress.lastIndexOf(':');
+        QTcpSocket *socket = new QTcpSocket(this);
+        connect(socket, &QTcpSocket::connected, this, &AmunClient::sendSubscription);
+        connect(socket, &QTcpSocket::disconnected, this, &AmunClient::remoteDisconnected);
+        connect(socket, static_cast<void (QTcpSocket::*)(QAbstractSocket::SocketError)>(&QTcpSocket::error),
+                this, &AmunClient::remoteDisconnected);
+        m_remote = socket;
+        socket->connectToHost(m_remoteAddress.left(split), m_remoteAddress.mid(split + 1).toUShort());
+    }
+    connect(m_remote, &QIODevice::readyRead, this, &AmunClient::readRemote);
+}
+
+void AmunClient::sendSubscription()
+{
+    const std::string data = m_subscription.SerializeAsString();
+    uchar header[4];
+    qToBigEndian<quint32>(data.size(), header);
+    m_remote->write(reinterpret_cast<const char *>(header), sizeof(header));
+    m_remote->write(data.data(), data.size());
+}
+
+void AmunClient::readRemote()
+{
+    m_buffer.append(m_remote->readAll());
+    int pos = 0;
+    while (m_buffer.size() - pos >= 4) {
+        const quint32 size = qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(m_buffer.constData() + pos));
+        if (quint32(m_buffer.size() - pos - 4) < size) {
+            break;
+        }
+
+        const QByteArray data = qUncompress(reinterpret_cast<const uchar *>(m_buffer.constData() + pos + 4), size);
+        pos += 4 + size;
+
+        Status status(new amun::Status);
+        // drop packets that can't be decoded, the server restarts the delta chain on reconnect
+        if (!status->ParseFromArray(data.constData(), data.size()) || !m_decoder.decode(status.data())) {
+            continue;
+        }
+        // already in the gui thread, the socket buffers what isn't read yet
+        emit gotStatusForLog(status);
+        emit gotStatus(status);
+    }
+    m_buffer.remove(0, pos);
+}
+
+void AmunClient::remoteDisconnected()
+{
+    if (m_remote == NULL) {
+        return;
+    }
+    // both the error and the disconnected signal may arrive
+    m_remote->disconnect(this);
+    m_remote->deleteLater();
+    m_remote = NULL;
+    QTimer::singleShot(RECONNECT_DELAY, this, SLOT(connectRemote()));
+}
+
 void AmunClient::stop()
 {
+    if (m_remote != NULL) {
+        m_remote->disconnect(this);
+        delete m_remote;
+        m_remote = NULL;
+    }
+    if (m_amunThread == NULL) {
+        return;
+    }
+
     m_amunThread->quit();
     m_amunThread->wait();
     delete m_amunThread;
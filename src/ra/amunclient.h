@@ -23,8 +23,13 @@
 
 #include "protobuf/command.h"
 #include "protobuf/status.h"
+#include "protobuf/statusdelta.h"
+#include "statusinbox.h"
+#include <QByteArray>
+#include <QMutex>
 
 class Amun;
+class QIODevice;
 class QThread;
 
 class AmunClient : public QObject
@@ -36,16 +41,41 @@ public:
     ~AmunClient() override;
 
 signals:
+    //! Status for the gui, may be coalesced if the gui doesn't keep up
     void gotStatus(const Status &status);
+    //! Every status, emitted from the thread which produced it
+    void gotStatusForLog(const Status &status);
     void sendCommand(const Command &command);
 
 public:
     void start();
+    void startRemote(const QString &address, const amun::StatusSubscription &subscription);
     void stop();
 
+    quint64 coalescedStatus();
+    quint64 droppedStatus();
+
+private slots:
+    void queueStatus(const Status &status);
+    void deliverStatus();
+    void connectRemote();
+    void sendSubscription();
+    void readRemote();
+    void remoteDisconnected();
+
 private:
     Amun* m_amun;
     QThread *m_amunThread;
+    // statuses of amun waiting for the gui thread
+    QMutex m_inboxMutex;
+    StatusInbox m_inbox;
+
+    // connection to the status server of a remote amun
+    QString m_remoteAddress;
+    QIODevice *m_remote;
+    amun::StatusSubscription m_subscription;
+    QByteArray m_buffer;
+    StatusDeltaDecoder m_decoder;
 };
 
 #endif // AMUNCLIENT_H
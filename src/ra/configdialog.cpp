@@ -27,6 +27,11 @@ const uint DEFAULT_SYSTEM_DELAY = 30; // in ms
 const uint DEFAULT_TRANSCEIVER_CHANNEL = 11;
 const uint DEFAULT_SIM_VISION_DELAY = 35; // in ms
 const uint DEFAULT_SIM_PROCESSING_TIME = 5; // in ms
+const uint DEFAULT_SIM_CAMERA_COUNT = 4;
+const uint DEFAULT_SIM_FRAME_RATE = 80; // in Hz
+const uint DEFAULT_SIM_DROPOUT = 0; // in percent
+const bool DEFAULT_SIM_STAGGER = false;
+const bool DEFAULT_SIM_ADAPTIVE_SUBSTEP = false;
 const uint DEFAULT_VISION_PORT = 10005;
 
 const bool DEFAULT_NETWORK_ENABLE = false;
@@ -61,6 +66,12 @@ void ConfigDialog::sendConfiguration()
 
     command->mutable_simulator()->set_vision_delay(ui->simVisionDelay->value() * 1000 * 1000);
     command->mutable_simulator()->set_vision_processing_time(ui->simProcessingTime->value() * 1000 * 1000);
+    amun::SimulatorVision *vision = command->mutable_simulator()->mutable_vision();
+    vision->set_camera_count(ui->simCameraCount->value());
+    vision->set_frame_rate(ui->simFrameRate->value());
+    vision->set_dropout(ui->simDropout->value() / 100.f);
+    vision->set_stagger(ui->simStagger->isChecked());
+    command->mutable_simulator()->set_adaptive_substep(ui->simAdaptiveSubstep->isChecked());
 
     command->mutable_amun()->set_vision_port(ui->visionPort->value());
 
@@ -85,6 +96,11 @@ void ConfigDialog::load()
 
     ui->simVisionDelay->setValue(s.value("Simulator/VisionDelay", DEFAULT_SIM_VISION_DELAY).toUInt());
     ui->simProcessingTime->setValue(s.value("Simulator/ProcessingTime", DEFAULT_SIM_PROCESSING_TIME).toUInt());
+    ui->simCameraCount->setValue(s.value("Simulator/CameraCount", DEFAULT_SIM_CAMERA_COUNT).toUInt());
+    ui->simFrameRate->setValue(s.value("Simulator/FrameRate", DEFAULT_SIM_FRAME_RATE).toUInt());
+    ui->simDropout->setValue(s.value("Simulator/Dropout", DEFAULT_SIM_DROPOUT).toUInt());
+    ui->simStagger->setChecked(s.value("Simulator/Stagger", DEFAULT_SIM_STAGGER).toBool());
+    ui->simAdaptiveSubstep->setChecked(s.value("Simulator/AdaptiveSubstep", DEFAULT_SIM_ADAPTIVE_SUBSTEP).toBool());
 
     ui->visionPort->setValue(s.value("Amun/VisionPort", DEFAULT_VISION_PORT).toUInt());
 
@@ -103,6 +119,11 @@ void ConfigDialog::reset()
     ui->systemDelayBox->setValue(DEFAULT_SYSTEM_DELAY);
     ui->simVisionDelay->setValue(DEFAULT_SIM_VISION_DELAY);
     ui->simProcessingTime->setValue(DEFAULT_SIM_PROCESSING_TIME);
+    ui->simCameraCount->setValue(DEFAULT_SIM_CAMERA_COUNT);
+    ui->simFrameRate->setValue(DEFAULT_SIM_FRAME_RATE);
+    ui->simDropout->setValue(DEFAULT_SIM_DROPOUT);
+    ui->simStagger->setChecked(DEFAULT_SIM_STAGGER);
+    ui->simAdaptiveSubstep->setChecked(DEFAULT_SIM_ADAPTIVE_SUBSTEP);
     ui->visionPort->setValue(DEFAULT_VISION_PORT);
     ui->networkUse->setChecked(DEFAULT_NETWORK_ENABLE);
     ui->networkHost->setText(DEFAULT_NETWORK_HOST);
@@ -119,6 +140,11 @@ void ConfigDialog::apply()
 
     s.setValue("Simulator/VisionDelay", ui->simVisionDelay->value());
     s.setValue("Simulator/ProcessingTime", ui->simProcessingTime->value());
+    s.setValue("Simulator/CameraCount", ui->simCameraCount->value());
+    s.setValue("Simulator/FrameRate", ui->simFrameRate->value());
+    s.setValue("Simulator/Dropout", ui->simDropout->value());
+    s.setValue("Simulator/Stagger", ui->simStagger->isChecked());
+    s.setValue("Simulator/AdaptiveSubstep", ui->simAdaptiveSubstep->isChecked());
 
     s.setValue("Amun/VisionPort", ui->visionPort->value());
 
@@ -24,20 +24,85 @@
 
 class DebugModel::Entry {
 public:
-    Entry(const QString &key, const QString &id) : id(id) {
+    Entry(const QString &key, const QString &id, Entry *parent) :
+        id(id),
+        parent(parent),
+        generation(0),
+        expanded(false),
+        textValid(true),
+        m_type(None)
+    {
         name = new QStandardItem(key);
         name->setData(id);
         value = new QStandardItem;
     }
 
+    // returns true if the value differs from the previous one
+    bool setValue(const amun::DebugValue &v) {
+        if (v.has_bool_value()) {
+            if (m_type == Bool && m_bool == v.bool_value()) {
+                return false;
+            }
+            m_type = Bool;
+            m_bool = v.bool_value();
+        } else if (v.has_float_value()) {
+            if (m_type == Float && m_float == v.float_value()) {
+                return false;
+            }
+            m_type = Float;
+            m_float = v.float_value();
+        } else if (v.has_string_value()) {
+            if (m_type == String && m_string == v.string_value()) {
+                return false;
+            }
+            m_type = String;
+            m_string = v.string_value();
+        } else {
+            if (m_type == Empty) {
+                return false;
+            }
+            m_type = Empty;
+        }
+        return true;
+    }
+
+    QString text() const {
+        switch (m_type) {
+        case Bool:
+            return QVariant(m_bool).toString();
+        case Float:
+            return QString::number(m_float);
+        case String:
+            return QString::fromStdString(m_string);
+        default:
+            return QString();
+        }
+    }
+
     QStandardItem *name;
     const QString id;
     QStandardItem *value;
+    Entry * const parent;
     DebugModel::Map children;
+    // key in the leaves map, null for entries that never had a value
+    QByteArray key;
+    // last update the entry was part of
+    quint64 generation;
+    bool expanded;
+    // false if the value item hasn't been updated as it's hidden
+    bool textValid;
+
+private:
+    enum Type { None, Empty, Bool, Float, String };
+    Type m_type;
+    bool m_bool;
+    float m_float;
+    std::string m_string;
 };
 
 DebugModel::DebugModel(QObject *parent) :
-    QStandardItemModel(parent)
+    QStandardItemModel(parent),
+    m_generation(0)
 {
     setHorizontalHeaderLabels(QStringList() << "Name" << "Value");
 
@@ -70,71 +135,135 @@ void DebugModel::clearData()
 
 void DebugModel::setDebug(const amun::DebugValues &debug, const QSet<QString> &debug_expanded)
 {
-    Map &map = m_debug[debug.source()];
-
     QStandardItem *parentItem = m_itemRoots.value(debug.source());
     if (parentItem == nullptr) {
         return;
     }
 
-    QSet<Entry*> entries;
+    Map &map = m_debug[debug.source()];
+    Leaves &leaves = m_leaves[debug.source()];
+    const quint64 generation = ++m_generation;
+    int seen = 0;
 
     for (int i = 0; i < debug.value_size(); i++) {
         const amun::DebugValue &value = debug.value(i);
+        const std::string &rawKey = value.key();
+
+        // the lookup doesn't copy the key
+        Entry *entry = leaves.value(QByteArray::fromRawData(rawKey.data(), int(rawKey.size())), nullptr);
+        if (entry == nullptr) {
+            entry = createEntry(parentItem, map, QString::fromStdString(rawKey), debug_expanded);
+            // prevent crash on invalid key
+            if (entry == nullptr) {
+                continue;
+            }
+            if (entry->key.isNull()) {
+                entry->key = QByteArray(rawKey.data(), int(rawKey.size()));
+                leaves[entry->key] = entry;
+            }
+        }
+
+        if (entry->generation != generation) {
+            entry->generation = generation;
+            seen++;
+        }
 
-        QString v; // convert to string
-        if (value.has_bool_value()) {
-            v = QVariant(value.bool_value()).toString();
-        } else if (value.has_float_value()) {
-            v = QString::number(value.float_value());
-        } else if (value.has_string_value()) {
-            v = QString::fromStdString(value.string_value());
+        // only touch the item if the value has changed, every update causes a model signal
+        if (entry->setValue(value)) {
+            // collapsed subtrees are updated once they are expanded
+            entry->textValid = isVisible(entry);
+            if (entry->textValid) {
+                entry->value->setText(entry->text());
+            }
         }
+    }
+
+    // remove outdated items, only necessary if a value is missing
+    if (seen != leaves.size()) {
+        testMap(map, leaves, generation);
+    }
+}
 
-        // strategy specific key
-        const QString keys = parentItem->text() % "/" % QString::fromStdString(value.key());
-        Entry *entry = m_entryMap.value(keys, NULL);
-        // key not cached yet
+DebugModel::Entry *DebugModel::createEntry(QStandardItem *parentItem, Map &map, const QString &valueKey,
+                                           const QSet<QString> &debug_expanded)
+{
+    // strategy specific key
+    const QString keys = parentItem->text() % "/" % valueKey;
+    Entry *entry = m_entryMap.value(keys, NULL);
+    // key already created as parent of another entry
+    if (entry != NULL) {
+        return entry;
+    }
+
+    // split key and create all parent items
+    QStringList key = keys.split("/", QString::SkipEmptyParts);
+
+    QStandardItem *parent = parentItem;
+    Entry *parentEntry = NULL;
+    QString name = key.takeFirst();
+
+    Map *m = &map;
+    foreach (const QString &k, key) {
+        name = name % "/" % k;
+
+        entry = m->value(k, NULL);
         if (entry == NULL) {
-            // split key and create all parent items
-            QStringList key = keys.split("/", QString::SkipEmptyParts);
-
-            QStandardItem *parent = parentItem;
-            QString name = key.takeFirst();
-
-            Map *m = &map;
-            foreach (const QString &k, key) {
-                name = name % "/" % k;
-
-                entry = m->value(k, NULL);
-                if (entry == NULL) {
-                    // allocate manually to allow using a lookup table
-                    entry = new Entry(k, name);
-                    (*m)[k] = entry; // add to tree
-                    m_entryMap[name] = entry; // add to map
-                    parent->appendRow(QList<QStandardItem*>() << entry->name << entry->value);
-
-                    if (debug_expanded.contains(name)) {
-                        emit expand(entry->name->index());
-                    }
-                }
-
-                parent = entry->name;
-                m = &entry->children;
+            // allocate manually to allow using a lookup table
+            entry = new Entry(k, name, parentEntry);
+            entry->expanded = debug_expanded.contains(name);
+            (*m)[k] = entry; // add to tree
+            m_entryMap[name] = entry; // add to map
+            parent->appendRow(QList<QStandardItem*>() << entry->name << entry->value);
+
+            if (entry->expanded) {
+                emit expand(entry->name->index());
             }
         }
 
-        // prevent crash on invalid key
-        if (entry != NULL) {
-            entries.insert(entry); // entry is valid
-            entry->value->setText(v); // already checks whether the value is changed
+        parent = entry->name;
+        parentEntry = entry;
+        m = &entry->children;
+    }
+    return entry;
+}
+
+bool DebugModel::isVisible(const Entry *entry)
+{
+    for (const Entry *parent = entry->parent; parent != NULL; parent = parent->parent) {
+        if (!parent->expanded) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void DebugModel::setExpanded(const QModelIndex &index, bool expanded)
+{
+    Entry *entry = m_entryMap.value(index.data(Qt::UserRole + 1).toString(), NULL);
+    if (entry == NULL) {
+        return;
+    }
+    entry->expanded = expanded;
+    if (expanded && isVisible(entry)) {
+        updateTexts(entry);
+    }
+}
+
+void DebugModel::updateTexts(Entry *entry)
+{
+    // publish values which were skipped while the entry was collapsed
+    foreach (Entry *child, entry->children) {
+        if (!child->textValid) {
+            child->value->setText(child->text());
+            child->textValid = true;
+        }
+        if (child->expanded) {
+            updateTexts(child);
         }
     }
-    // remove outdated items
-    testMap(map, entries);
 }
 
-void DebugModel::testMap(DebugModel::Map &map, const QSet<Entry*> &entries)
+void DebugModel::testMap(DebugModel::Map &map, Leaves &leaves, quint64 generation)
 {
     QMutableHashIterator<QString, Entry*> it(map);
     while (it.hasNext()) {
@@ -142,17 +271,20 @@ void DebugModel::testMap(DebugModel::Map &map, const QSet<Entry*> &entries)
 
         // cleanup when unwinding recursion
         Entry *entry = it.value();
-        testMap(entry->children, entries);
+        testMap(entry->children, leaves, generation);
         // remove unneccessary leaves
         // a entry is only removed if all its childs have been removed before
         // thus m_entryMap cannot contain outdated values
-        if (entry->children.size() == 0 && !entries.contains(entry)) {
+        if (entry->children.size() == 0 && entry->generation != generation) {
             QStandardItem *item = entry->name;
             QStandardItem *parent = item->parent();
             // remove and delete
             parent->removeRows(item->row(), 1);
             it.remove();
             m_entryMap.remove(entry->id);
+            if (!entry->key.isNull()) {
+                leaves.remove(entry->key);
+            }
             delete entry;
         }
     }
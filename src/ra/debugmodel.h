@@ -38,17 +38,25 @@ signals:
 public:
     void clearData();
     void setDebug(const amun::DebugValues &debug, const QSet<QString> &debug_expanded);
+    void setExpanded(const QModelIndex &index, bool expanded);
 
 private:
     void addRootItem(const QString &name, int sourceId);
     class Entry;
     typedef QHash<QString, Entry*> Map;
-    void testMap(Map &map, const QSet<Entry*> &entries);
+    // entries by the unmodified key of their debug value
+    typedef QHash<QByteArray, Entry*> Leaves;
+    Entry *createEntry(QStandardItem *parentItem, Map &map, const QString &key, const QSet<QString> &debug_expanded);
+    void testMap(Map &map, Leaves &leaves, quint64 generation);
+    static bool isVisible(const Entry *entry);
+    void updateTexts(Entry *entry);
 
 private:
     QHash<int, QStandardItem*> m_itemRoots;
     Map m_entryMap;
     QHash<int, Map> m_debug;
+    QHash<int, Leaves> m_leaves;
+    quint64 m_generation;
 };
 
 #endif // DEBUGMODEL_H
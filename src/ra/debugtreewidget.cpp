@@ -94,6 +94,7 @@ void DebugTreeWidget::save()
 
 void DebugTreeWidget::debugExpanded(const QModelIndex &index)
 {
+    m_modelTree->setExpanded(index, true);
     const QString name = index.data(Qt::UserRole + 1).toString();
     if (!m_expanded.contains(name)) {
         m_expanded.insert(name);
@@ -103,6 +104,7 @@ void DebugTreeWidget::debugExpanded(const QModelIndex &index)
 
 void DebugTreeWidget::debugCollapsed(const QModelIndex &index)
 {
+    m_modelTree->setExpanded(index, false);
     const QString name = index.data(Qt::UserRole + 1).toString();
     if (m_expanded.remove(name)) {
         save();
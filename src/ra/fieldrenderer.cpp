@@ -0,0 +1,607 @@
+/***************************************************************************
+ *   Copyright 2016 Robotics Erlangen e.V.                                 *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include "fieldrenderer.h"
+#include <QOpenGLBuffer>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QMatrix4x4>
+#include <QPaintEngine>
+#include <QPainter>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+static const char *vertexShader =
+        "attribute highp vec2 position;\n"
+        "attribute mediump vec3 shape;\n"
+        "attribute lowp vec4 color;\n"
+        "uniform highp mat4 matrix;\n"
+        "varying mediump vec3 v_shape;\n"
+        "varying lowp vec4 v_color;\n"
+        "void main() {\n"
+        "    gl_Position = matrix * vec4(position, 0.0, 1.0);\n"
+        "    v_shape = shape;\n"
+        "    v_color = color;\n"
+        "}\n";
+
+// circles are drawn as quads, everything outside of the ring is discarded
+// plain triangles use a shape of zero which is always inside
+static const char *fragmentShader =
+        "varying mediump vec3 v_shape;\n"
+        "varying lowp vec4 v_color;\n"
+        "void main() {\n"
+        "    mediump float d = dot(v_shape.xy, v_shape.xy);\n"
+        "    if (d > 1.0 || d < v_shape.z * v_shape.z) {\n"
+        "        discard;\n"
+        "    }\n"
+        "    gl_FragColor = v_color;\n"
+        "}\n";
+
+enum AttributeLocation {
+    PositionAttribute = 0,
+    ShapeAttribute = 1,
+    ColorAttribute = 2
+};
+
+/*!
+ * \class FieldRenderer
+ * \ingroup ra
+ * \brief Batched renderer for visualizations and traces on the field
+ *
+ * Shapes are collected in batches, which are identified by an arbitrary key and
+ * can be replaced independently of each other. Every shape keeps its own
+ * tesselation, which is only recomputed after the shape has changed. Each layer
+ * is drawn with a single draw call if an OpenGL viewport is used, the vertex
+ * buffer is only uploaded after a batch of that layer has changed. Other paint
+ * devices are drawn using the QPainter API.
+ */
+
+FieldRenderer::FieldRenderer() :
+    m_context(NULL),
+    m_program(NULL)
+{
+    for (int i = 0; i < LayerCount; i++) {
+        m_layerChanged[i] = true;
+        m_buffers[i] = NULL;
+        m_vertexCount[i] = 0;
+    }
+}
+
+FieldRenderer::~FieldRenderer()
+{
+    resetGL();
+}
+
+/*!
+ * \brief Remove all shapes of a batch
+ */
+void FieldRenderer::clear(int batch)
+{
+    QMap<int, Batch>::iterator it = m_batches.find(batch);
+    if (it == m_batches.end()) {
+        return;
+    }
+    for (int i = 0; i < LayerCount; i++) {
+        if (!it->layers[i].primitives.isEmpty()) {
+            m_layerChanged[i] = true;
+        }
+    }
+    m_batches.erase(it);
+}
+
+/*!
+ * \brief Start replacing the shapes of a batch
+ *
+ * The shapes added until endBatch is called replace the previous ones in order.
+ * Shapes which are equal to the one they replace keep their tesselation.
+ */
+void FieldRenderer::beginBatch(int batch)
+{
+    Batch &b = m_batches[batch];
+    for (int i = 0; i < LayerCount; i++) {
+        b.layers[i].next = 0;
+    }
+}
+
+/*!
+ * \brief Remove the shapes of a batch that weren't replaced since beginBatch
+ */
+void FieldRenderer::endBatch(int batch)
+{
+    QMap<int, Batch>::iterator it = m_batches.find(batch);
+    if (it == m_batches.end()) {
+        return;
+    }
+
+    bool isEmpty = true;
+    for (int i = 0; i < LayerCount; i++) {
+        Geometry &geometry = it->layers[i];
+        if (geometry.next >= 0 && geometry.next < geometry.primitives.size()) {
+            geometry.primitives.erase(geometry.primitives.begin() + geometry.next, geometry.primitives.end());
+            m_layerChanged[i] = true;
+        }
+        geometry.next = -1;
+        isEmpty &= geometry.primitives.isEmpty();
+    }
+    if (isEmpty) {
+        m_batches.erase(it);
+    }
+}
+
+/*!
+ * \brief Remove the oldest shapes of a batch
+ *
+ * The remaining shapes aren't tesselated again.
+ */
+void FieldRenderer::removeFirst(int batch, Layer layer, int count)
+{
+    QMap<int, Batch>::iterator it = m_batches.find(batch);
+    if (it == m_batches.end() || count <= 0) {
+        return;
+    }
+
+    QList<Primitive> &primitives = it->layers[layer].primitives;
+    count = qMin(count, primitives.size());
+    primitives.erase(primitives.begin(), primitives.begin() + count);
+    m_layerChanged[layer] = true;
+}
+
+void FieldRenderer::addCircle(int batch, Layer layer, const QPointF &center, float radius, const QPen &pen, const QBrush &brush)
+{
+    addPrimitive(batch, layer, Primitive::Circle, &center, 1, radius, pen, brush);
+}
+
+void FieldRenderer::addPolygon(int batch, Layer layer, const QPolygonF &polygon, const QPen &pen, const QBrush &brush)
+{
+    addPrimitive(batch, layer, Primitive::Polygon, polygon.constData(), polygon.size(), 0, pen, brush);
+}
+
+void FieldRenderer::addPath(int batch, Layer layer, const QPolygonF &path, const QPen &pen, const QBrush &brush)
+{
+    if (path.size() > 1) {
+        addPrimitive(batch, layer, Primitive::Path, path.constData(), path.size(), 0, pen, brush);
+    }
+}
+
+void FieldRenderer::addPrimitive(int batch, Layer layer, Primitive::Type type, const QPointF *points, int count,
+                                 float radius, const QPen &pen, const QBrush &brush)
+{
+    Geometry &geometry = m_batches[batch].layers[layer];
+
+    Primitive *primitive;
+    if (geometry.next >= 0 && geometry.next < geometry.primitives.size()) {
+        // replace the shape at the same position, if it has changed at all
+        primitive = &geometry.primitives[geometry.next++];
+        if (isEqual(*primitive, type, points, count, radius, pen, brush)) {
+            return;
+        }
+    } else {
+        if (geometry.next >= 0) {
+            geometry.next++;
+        }
+        geometry.primitives.append(Primitive());
+        primitive = &geometry.primitives.last();
+    }
+
+    primitive->type = type;
+    primitive->pen = pen;
+    primitive->brush = brush;
+    primitive->radius = radius;
+    primitive->points.resize(count);
+    std::copy(points, points + count, primitive->points.begin());
+    primitive->verticesValid = false;
+    m_layerChanged[layer] = true;
+}
+
+bool FieldRenderer::isEqual(const Primitive &primitive, Primitive::Type type, const QPointF *points, int count,
+                            float radius, const QPen &pen, const QBrush &brush)
+{
+    return primitive.type == type && primitive.radius == radius
+            && primitive.points.size() == count && std::equal(points, points + count, primitive.points.constBegin())
+            && primitive.pen == pen && primitive.brush == brush;
+}
+
+/*!
+ * \brief Draw a layer
+ *
+ * Uses OpenGL if the painter draws on an OpenGL surface, this also works with
+ * software implementations like Mesa llvmpipe.
+ */
+void FieldRenderer::paint(QPainter *painter, Layer layer)
+{
+    QPaintEngine *engine = painter->paintEngine();
+    if (engine && engine->type() == QPaintEngine::OpenGL2 && QOpenGLContext::currentContext()) {
+        paintGL(painter, layer);
+    } else {
+        paintRaster(painter, layer);
+    }
+}
+
+/*!
+ * \brief Release OpenGL resources
+ *
+ * Must be called before the OpenGL viewport is replaced.
+ */
+void FieldRenderer::resetGL()
+{
+    delete m_program;
+    m_program = NULL;
+    for (int i = 0; i < LayerCount; i++) {
+        delete m_buffers[i];
+        m_buffers[i] = NULL;
+        m_layerChanged[i] = true;
+    }
+    m_context = NULL;
+}
+
+void FieldRenderer::paintRaster(QPainter *painter, Layer layer)
+{
+    foreach (const Batch &batch, m_batches) {
+        foreach (const Primitive &primitive, batch.layers[layer].primitives) {
+            const QPointF *p = primitive.points.constData();
+            const int count = primitive.points.size();
+            painter->setPen(primitive.pen);
+            painter->setBrush(primitive.brush);
+            switch (primitive.type) {
+            case Primitive::Circle:
+                painter->drawEllipse(p[0], primitive.radius, primitive.radius);
+                break;
+
+            case Primitive::Polygon:
+                painter->drawPolygon(p, count);
+                break;
+
+            case Primitive::Path:
+                // the filled area is closed implicitly, but not the outline
+                if (primitive.brush.style() != Qt::NoBrush) {
+                    painter->setPen(Qt::NoPen);
+                    painter->drawPolygon(p, count);
+                    painter->setPen(primitive.pen);
+                }
+                painter->drawPolyline(p, count);
+                break;
+            }
+        }
+    }
+}
+
+bool FieldRenderer::initializeGL()
+{
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (context != m_context) {
+        resetGL();
+    }
+    if (m_program) {
+        return m_program->isLinked();
+    }
+
+    m_context = context;
+    m_program = new QOpenGLShaderProgram;
+    m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShader);
+    m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShader);
+    m_program->bindAttributeLocation("position", PositionAttribute);
+    m_program->bindAttributeLocation("shape", ShapeAttribute);
+    m_program->bindAttributeLocation("color", ColorAttribute);
+    if (!m_program->link()) {
+        // fall back to the QPainter for this context
+        return false;
+    }
+
+    for (int i = 0; i < LayerCount; i++) {
+        m_buffers[i] = new QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+        m_buffers[i]->setUsagePattern(QOpenGLBuffer::DynamicDraw);
+        m_buffers[i]->create();
+        m_layerChanged[i] = true;
+    }
+    return true;
+}
+
+void FieldRenderer::paintGL(QPainter *painter, Layer layer)
+{
+    painter->beginNativePainting();
+    if (!initializeGL()) {
+        painter->endNativePainting();
+        paintRaster(painter, layer);
+        return;
+    }
+
+    QOpenGLBuffer *buffer = m_buffers[layer];
+    buffer->bind();
+
+    if (m_layerChanged[layer]) {
+        // only tesselate shapes that have changed
+        int count = 0;
+        for (QMap<int, Batch>::iterator it = m_batches.begin(); it != m_batches.end(); ++it) {
+            QList<Primitive> &primitives = it->layers[layer].primitives;
+            for (QList<Primitive>::iterator primitive = primitives.begin(); primitive != primitives.end(); ++primitive) {
+                if (!primitive->verticesValid) {
+                    primitive->vertices.clear();
+                    tesselate(*primitive, primitive->vertices);
+                    primitive->verticesValid = true;
+                }
+                count += primitive->vertices.size();
+            }
+        }
+
+        // upload the whole layer at once
+        m_vertices.resize(count);
+        Vertex *vertex = m_vertices.data();
+        foreach (const Batch &batch, m_batches) {
+            foreach (const Primitive &primitive, batch.layers[layer].primitives) {
+                vertex = std::copy(primitive.vertices.constBegin(), primitive.vertices.constEnd(), vertex);
+            }
+        }
+        buffer->allocate(m_vertices.constData(), count * sizeof(Vertex));
+        m_vertexCount[layer] = count;
+        m_layerChanged[layer] = false;
+    }
+
+    if (m_vertexCount[layer] > 0) {
+        // map from logical device pixels to normalized device coordinates
+        QMatrix4x4 matrix;
+        matrix.ortho(0, painter->device()->width(), painter->device()->height(), 0, -1, 1);
+        matrix *= QMatrix4x4(painter->combinedTransform());
+
+        QOpenGLFunctions *f = m_context->functions();
+        m_program->bind();
+        m_program->setUniformValue("matrix", matrix);
+        m_program->enableAttributeArray(PositionAttribute);
+        m_program->setAttributeBuffer(PositionAttribute, GL_FLOAT, offsetof(Vertex, x), 2, sizeof(Vertex));
+        m_program->enableAttributeArray(ShapeAttribute);
+        m_program->setAttributeBuffer(ShapeAttribute, GL_FLOAT, offsetof(Vertex, u), 3, sizeof(Vertex));
+        m_program->enableAttributeArray(ColorAttribute);
+        f->glVertexAttribPointer(ColorAttribute, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex),
+                                 reinterpret_cast<const void *>(offsetof(Vertex, color)));
+
+        f->glEnable(GL_BLEND);
+        f->glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        f->glDrawArrays(GL_TRIANGLES, 0, m_vertexCount[layer]);
+
+        m_program->disableAttributeArray(PositionAttribute);
+        m_program->disableAttributeArray(ShapeAttribute);
+        m_program->disableAttributeArray(ColorAttribute);
+        m_program->release();
+    }
+
+    buffer->release();
+    painter->endNativePainting();
+}
+
+void FieldRenderer::tesselate(const Primitive &primitive, QVector<Vertex> &vertices)
+{
+    const QPointF *points = primitive.points.constData();
+    const int count = primitive.points.size();
+    const bool fill = (primitive.brush.style() != Qt::NoBrush);
+    const bool stroke = (primitive.pen.style() != Qt::NoPen);
+
+    switch (primitive.type) {
+    case Primitive::Circle:
+        if (fill) {
+            addDisc(vertices, points[0], primitive.radius, 0, primitive.brush.color());
+        }
+        if (stroke && primitive.pen.style() == Qt::SolidLine) {
+            const float halfWidth = primitive.pen.widthF() / 2;
+            const float outer = primitive.radius + halfWidth;
+            const float inner = std::max(0.f, primitive.radius - halfWidth);
+            addDisc(vertices, points[0], outer, inner / outer, primitive.pen.color());
+        } else if (stroke) {
+            // dashed outlines are drawn along a polygon
+            const int segments = 64;
+            QPointF outline[segments];
+            for (int i = 0; i < segments; i++) {
+                const float angle = 2 * M_PI * i / segments;
+                outline[i] = points[0] + QPointF(std::cos(angle), std::sin(angle)) * primitive.radius;
+            }
+            addStroke(vertices, outline, segments, true, primitive.pen);
+        }
+        break;
+
+    case Primitive::Polygon:
+    case Primitive::Path:
+        if (fill) {
+            addFill(vertices, points, count, primitive.brush.color());
+        }
+        if (stroke) {
+            addStroke(vertices, points, count, primitive.type == Primitive::Polygon, primitive.pen);
+        }
+        break;
+    }
+}
+
+void FieldRenderer::setVertex(Vertex *vertex, float x, float y, float u, float v, float inner, const QColor &color)
+{
+    vertex->x = x;
+    vertex->y = y;
+    vertex->u = u;
+    vertex->v = v;
+    vertex->inner = inner;
+    vertex->color[0] = color.red();
+    vertex->color[1] = color.green();
+    vertex->color[2] = color.blue();
+    vertex->color[3] = color.alpha();
+}
+
+void FieldRenderer::addTriangle(QVector<Vertex> &vertices, const QPointF &a, const QPointF &b, const QPointF &c, const QColor &color)
+{
+    const int size = vertices.size();
+    vertices.resize(size + 3);
+    setVertex(&vertices[size], a.x(), a.y(), 0, 0, 0, color);
+    setVertex(&vertices[size + 1], b.x(), b.y(), 0, 0, 0, color);
+    setVertex(&vertices[size + 2], c.x(), c.y(), 0, 0, 0, color);
+}
+
+void FieldRenderer::addDisc(QVector<Vertex> &vertices, const QPointF &center, float radius, float inner, const QColor &color)
+{
+    const float x = center.x();
+    const float y = center.y();
+    const int size = vertices.size();
+    vertices.resize(size + 6);
+    Vertex *v = &vertices[size];
+    setVertex(v++, x - radius, y - radius, -1, -1, inner, color);
+    setVertex(v++, x + radius, y - radius,  1, -1, inner, color);
+    setVertex(v++, x + radius, y + radius,  1,  1, inner, color);
+    setVertex(v++, x - radius, y - radius, -1, -1, inner, color);
+    setVertex(v++, x + radius, y + radius,  1,  1, inner, color);
+    setVertex(v++, x - radius, y + radius, -1,  1, inner, color);
+}
+
+void FieldRenderer::addSegment(QVector<Vertex> &vertices, const QPointF &from, const QPointF &to, float width, const QColor &color)
+{
+    const QPointF dir = to - from;
+    const float length = std::sqrt(QPointF::dotProduct(dir, dir));
+    if (length <= 0) {
+        return;
+    }
+    const QPointF normal = QPointF(-dir.y(), dir.x()) * (width / 2 / length);
+    addTriangle(vertices, from + normal, from - normal, to - normal, color);
+    addTriangle(vertices, from + normal, to - normal, to + normal, color);
+}
+
+static float cross(const QPointF &a, const QPointF &b, const QPointF &c)
+{
+    return (b.x() - a.x()) * (c.y() - a.y()) - (b.y() - a.y()) * (c.x() - a.x());
+}
+
+/*!
+ * \brief Fill a simple polygon using ear clipping
+ *
+ * Self-intersecting polygons are filled with a triangle fan of the remaining points.
+ */
+void FieldRenderer::addFill(QVector<Vertex> &vertices, const QPointF *points, int count, const QColor &color)
+{
+    if (count < 3) {
+        return;
+    }
+
+    float area = 0;
+    for (int i = 0; i < count; i++) {
+        const QPointF &a = points[i];
+        const QPointF &b = points[(i + 1) % count];
+        area += a.x() * b.y() - b.x() * a.y();
+    }
+    const float orientation = (area >= 0) ? 1 : -1;
+
+    QVector<int> indices(count);
+    for (int i = 0; i < count; i++) {
+        indices[i] = i;
+    }
+
+    int i = 0;
+    int failed = 0;
+    while (indices.size() > 3 && failed < indices.size()) {
+        const int n = indices.size();
+        const QPointF &prev = points[indices[(i + n - 1) % n]];
+        const QPointF &cur = points[indices[i % n]];
+        const QPointF &next = points[indices[(i + 1) % n]];
+
+        bool isEar = (cross(prev, cur, next) * orientation > 0);
+        for (int j = 0; isEar && j < n; j++) {
+            const QPointF &p = points[indices[j]];
+            if (p == prev || p == cur || p == next) {
+                continue;
+            }
+            isEar = !(cross(prev, cur, p) * orientation >= 0
+                      && cross(cur, next, p) * orientation >= 0
+                      && cross(next, prev, p) * orientation >= 0);
+        }
+
+        if (isEar) {
+            addTriangle(vertices, prev, cur, next, color);
+            indices.remove(i % n);
+            failed = 0;
+        } else {
+            i++;
+            failed++;
+        }
+        i %= indices.size();
+    }
+
+    for (int j = 1; j + 1 < indices.size(); j++) {
+        addTriangle(vertices, points[indices[0]], points[indices[j]], points[indices[j + 1]], color);
+    }
+}
+
+void FieldRenderer::addStroke(QVector<Vertex> &vertices, const QPointF *points, int count, bool closed, const QPen &pen)
+{
+    // cosmetic pens aren't supported, use the default visualization width instead
+    const float width = (pen.widthF() > 0) ? pen.widthF() : 0.01f;
+    const QColor color = pen.color();
+    const int segments = (closed) ? count : count - 1;
+
+    // the dash pattern is given in multiples of the pen width
+    QVector<qreal> pattern = pen.dashPattern();
+    qreal patternLength = 0;
+    for (int i = 0; i < pattern.size(); i++) {
+        pattern[i] *= width;
+        patternLength += pattern[i];
+    }
+
+    if (pen.style() == Qt::SolidLine || pattern.size() < 2 || patternLength <= 0) {
+        for (int i = 0; i < segments; i++) {
+            addSegment(vertices, points[i], points[(i + 1) % count], width, color);
+        }
+        // round joins and caps
+        for (int i = 0; i < count; i++) {
+            addDisc(vertices, points[i], width / 2, 0, color);
+        }
+        return;
+    }
+
+    int index = 0;
+    qreal remaining = pattern[0];
+    for (int i = 0; i < segments; i++) {
+        const QPointF &from = points[i];
+        const QPointF dir = points[(i + 1) % count] - from;
+        const qreal length = std::sqrt(QPointF::dotProduct(dir, dir));
+        qreal pos = 0;
+        while (pos < length) {
+            const qreal step = std::min(remaining, length - pos);
+            // even entries of the pattern are dashes, odd ones are spaces
+            if (index % 2 == 0) {
+                addSegment(vertices, from + dir * (pos / length), from + dir * ((pos + step) / length), width, color);
+            }
+            pos += step;
+            remaining -= step;
+            if (remaining <= 0) {
+                index = (index + 1) % pattern.size();
+                remaining = pattern[index];
+            }
+        }
+    }
+}
+
+FieldRendererItem::FieldRendererItem(FieldRenderer *renderer, FieldRenderer::Layer layer) :
+    m_renderer(renderer),
+    m_layer(layer)
+{
+}
+
+QRectF FieldRendererItem::boundingRect() const
+{
+    // large enough for every field, the shapes aren't clipped anyway
+    return QRectF(-50, -50, 100, 100);
+}
+
+void FieldRendererItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
+{
+    m_renderer->paint(painter, m_layer);
+}
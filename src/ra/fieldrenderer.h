@@ -0,0 +1,141 @@
+/***************************************************************************
+ *   Copyright 2016 Robotics Erlangen e.V.                                 *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef FIELDRENDERER_H
+#define FIELDRENDERER_H
+
+#include <QBrush>
+#include <QGraphicsItem>
+#include <QList>
+#include <QMap>
+#include <QPen>
+#include <QPolygonF>
+#include <QVector>
+
+class QOpenGLBuffer;
+class QOpenGLContext;
+class QOpenGLShaderProgram;
+
+class FieldRenderer
+{
+public:
+    enum Layer {
+        Background = 0,
+        Traces = 1,
+        Foreground = 2,
+        LayerCount = 3
+    };
+
+    FieldRenderer();
+    ~FieldRenderer();
+
+    void clear(int batch);
+    void beginBatch(int batch);
+    void endBatch(int batch);
+    void removeFirst(int batch, Layer layer, int count);
+    void addCircle(int batch, Layer layer, const QPointF &center, float radius, const QPen &pen, const QBrush &brush);
+    void addPolygon(int batch, Layer layer, const QPolygonF &polygon, const QPen &pen, const QBrush &brush);
+    void addPath(int batch, Layer layer, const QPolygonF &path, const QPen &pen, const QBrush &brush);
+
+    void paint(QPainter *painter, Layer layer);
+    void resetGL();
+
+private:
+    Q_DISABLE_COPY(FieldRenderer)
+
+    struct Vertex
+    {
+        float x;
+        float y;
+        // position relative to a circle center, scaled to its outer radius
+        float u;
+        float v;
+        // inner radius of a ring relative to its outer radius
+        float inner;
+        quint8 color[4];
+    };
+
+    struct Primitive
+    {
+        enum Type { Circle, Polygon, Path };
+        Type type;
+        QPen pen;
+        QBrush brush;
+        float radius;
+        QVector<QPointF> points;
+        QVector<Vertex> vertices;
+        bool verticesValid;
+    };
+
+    struct Geometry
+    {
+        Geometry() : next(-1) {}
+        QList<Primitive> primitives;
+        // index of the primitive replaced by the next add call, appends if negative
+        int next;
+    };
+
+    struct Batch
+    {
+        Geometry layers[LayerCount];
+    };
+
+    void addPrimitive(int batch, Layer layer, Primitive::Type type, const QPointF *points, int count,
+                      float radius, const QPen &pen, const QBrush &brush);
+    void paintRaster(QPainter *painter, Layer layer);
+    void paintGL(QPainter *painter, Layer layer);
+    bool initializeGL();
+
+    static bool isEqual(const Primitive &primitive, Primitive::Type type, const QPointF *points, int count,
+                        float radius, const QPen &pen, const QBrush &brush);
+    static void setVertex(Vertex *vertex, float x, float y, float u, float v, float inner, const QColor &color);
+    static void tesselate(const Primitive &primitive, QVector<Vertex> &vertices);
+    static void addTriangle(QVector<Vertex> &vertices, const QPointF &a, const QPointF &b, const QPointF &c, const QColor &color);
+    static void addDisc(QVector<Vertex> &vertices, const QPointF &center, float radius, float inner, const QColor &color);
+    static void addSegment(QVector<Vertex> &vertices, const QPointF &from, const QPointF &to, float width, const QColor &color);
+    static void addFill(QVector<Vertex> &vertices, const QPointF *points, int count, const QColor &color);
+    static void addStroke(QVector<Vertex> &vertices, const QPointF *points, int count, bool closed, const QPen &pen);
+
+private:
+    QMap<int, Batch> m_batches;
+    bool m_layerChanged[LayerCount];
+    QVector<Vertex> m_vertices;
+
+    QOpenGLContext *m_context;
+    QOpenGLShaderProgram *m_program;
+    QOpenGLBuffer *m_buffers[LayerCount];
+    int m_vertexCount[LayerCount];
+};
+
+// draws one layer of a FieldRenderer as part of a QGraphicsScene
+class FieldRendererItem : public QGraphicsItem
+{
+public:
+    FieldRendererItem(FieldRenderer *renderer, FieldRenderer::Layer layer);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
+private:
+    FieldRenderer *m_renderer;
+    const FieldRenderer::Layer m_layer;
+};
+
+#endif // FIELDRENDERER_H
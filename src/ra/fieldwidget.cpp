@@ -26,6 +26,7 @@
 #include <QContextMenuEvent>
 #include <QMenu>
 #include <cmath>
+#include <cstring>
 #include <QGraphicsRectItem>
 #include <QGLWidget>
 #include <QSettings>
@@ -35,6 +36,11 @@
 #include <QGestureRecognizer>
 #include <QGuiApplication>
 
+// world states kept until the next redraw, older ones are dropped
+static const int WORLD_STATE_CAPACITY = 100;
+// minimal time between two world states used for traces, in ns
+static const qint64 TRACE_SAMPLE_INTERVAL = 10 * 1000 * 1000;
+
 class TouchStatusGesture : public QGesture
 {
 public:
@@ -100,7 +106,7 @@ FieldWidget::FieldWidget(QWidget *parent) :
     QGraphicsView(parent),
     m_geometryUpdated(true),
     m_rotation(0.0f),
-    m_visualizationsUpdated(false),
+    m_worldState(WORLD_STATE_CAPACITY, TRACE_SAMPLE_INTERVAL),
     m_infoTextUpdated(false),
     m_hasTouchInput(false),
     m_dragType(DragNone),
@@ -193,23 +199,33 @@ FieldWidget::FieldWidget(QWidget *parent) :
     m_scene->addItem(m_aoiItem);
     m_aoi = QRectF(-1, -1, 2, 2);
 
+    // traces and visualizations are drawn in batches, one item per layer
+    m_renderer = new FieldRenderer;
+    const float layerZValues[FieldRenderer::LayerCount] = { 1.0f, 2.0f, 10.0f };
+    for (int i = 0; i < FieldRenderer::LayerCount; i++) {
+        m_rendererItems[i] = new FieldRendererItem(m_renderer, FieldRenderer::Layer(i));
+        m_rendererItems[i]->setZValue(layerZValues[i]);
+        m_scene->addItem(m_rendererItems[i]);
+    }
+
+    // visualization sources use positive batch ids
     QColor ballColor(255, 66, 0);
     m_ballTrace.color = ballColor.darker();
-    m_ballTrace.z_index = 2.f;
+    m_ballTrace.batch = -3;
     m_ballRawTrace.color = ballColor.darker(300);
-    m_ballRawTrace.z_index = 1.f;
+    m_ballRawTrace.batch = -6;
 
     QColor robotYellowColor = QColor(Qt::yellow);
     m_robotYellowTrace.color = robotYellowColor.darker();
-    m_robotYellowTrace.z_index = 2.f;
+    m_robotYellowTrace.batch = -2;
     m_robotYellowRawTrace.color = robotYellowColor.darker(300);
-    m_robotYellowRawTrace.z_index = 1.f;
+    m_robotYellowRawTrace.batch = -5;
 
     QColor robotBlueColor = QColor(Qt::blue);
     m_robotBlueTrace.color = robotBlueColor.darker();
-    m_robotBlueTrace.z_index = 2.f;
+    m_robotBlueTrace.batch = -1;
     m_robotBlueRawTrace.color = robotBlueColor.darker(300);
-    m_robotBlueRawTrace.z_index = 1.f;
+    m_robotBlueRawTrace.batch = -4;
 
     m_infoTextItem = new QGraphicsTextItem;
     m_infoTextItem->setZValue(10000);
@@ -251,6 +267,9 @@ FieldWidget::~FieldWidget()
     s.setValue("BallTraces", m_actionShowBallTraces->isChecked());
     s.setValue("RobotTraces", m_actionShowRobotTraces->isChecked());
     s.endGroup();
+
+    makeGLCurrent();
+    delete m_renderer;
 }
 
 void FieldWidget::setLogplayer()
@@ -261,8 +280,7 @@ void FieldWidget::setLogplayer()
 void FieldWidget::handleStatus(const Status &status)
 {
     if (status->has_world_state()) {
-        m_worldState.append(status);
-        m_lastWorldState = status;
+        m_worldState.push(status);
         m_guiTimer->requestTriggering();
     }
 
@@ -287,7 +305,7 @@ void FieldWidget::handleStatus(const Status &status)
     if (status->has_debug()) {
         // just save status to avoid copying the visualizations
         m_visualizations[status->debug().source()] = status;
-        m_visualizationsUpdated = true;
+        m_visualizationsUpdated.insert(status->debug().source());
         m_guiTimer->requestTriggering();
     }
 }
@@ -312,10 +330,9 @@ void FieldWidget::clearData()
     clearTraces();
 
     m_worldState.clear();
-    m_lastWorldState.clear();
 
+    invalidateVisualizations();
     m_visualizations.clear();
-    m_visualizationsUpdated = true;
 
     geometrySetDefault(&m_geometry);
     m_geometryUpdated = true;
@@ -345,7 +362,10 @@ void FieldWidget::visualizationsChanged(const QStringList &items)
 {
     // list of visible visualizations was changed
     m_visibleVisualizations = items;
-    m_visualizationsUpdated = true; // force redraw
+    for (QHash<QByteArray, bool>::iterator it = m_visualizationVisible.begin(); it != m_visualizationVisible.end(); ++it) {
+        it.value() = items.contains(QString::fromUtf8(it.key()));
+    }
+    invalidateVisualizations(); // force redraw
     m_guiTimer->requestTriggering();
 }
 
@@ -354,6 +374,7 @@ void FieldWidget::updateAll()
     // update everything
     updateGeometry();
     updateDetection();
+    updateTraces();
     updateVisualizations();
     updateInfoText();
 }
@@ -365,7 +386,7 @@ void FieldWidget::updateVisualizationVisibility()
     m_visibleVisSources[amun::Controller] = m_actionShowControllerVis->isChecked();
     m_visibleVisSources[amun::Autoref] = true;
 
-    m_visualizationsUpdated = true;
+    invalidateVisualizations();
     m_guiTimer->requestTriggering();
 }
 
@@ -378,147 +399,154 @@ void FieldWidget::updateTracesVisibility()
     if (!m_actionShowRobotTraces->isChecked()) {
         clearRobotTraces();
     }
+    m_guiTimer->requestTriggering();
+}
+
+void FieldWidget::invalidateVisualizations()
+{
+    // force redrawing all sources
+    foreach (int source, m_visualizations.keys()) {
+        m_visualizationsUpdated.insert(source);
+    }
 }
 
 void FieldWidget::updateVisualizations()
 {
-    if (!m_visualizationsUpdated) {
+    if (m_visualizationsUpdated.isEmpty()) {
         return;
     }
-    m_visualizationsUpdated = false; // don't redraw if nothing new has happened
 
-    // delete visualizations and redraw everything
-    qDeleteAll(m_visualizationItems);
-    m_visualizationItems.clear();
-
-    foreach (const Status &v, m_visualizations) {
-        if (m_visibleVisSources.value(v->debug().source())) {
-            updateVisualizations(v->debug());
-        }
+    // only rebuild the batches of sources that changed since the last frame
+    foreach (int source, m_visualizationsUpdated) {
+        const Status status = m_visualizations.value(source);
+        const bool visible = !status.isNull() && m_visibleVisSources.value(source);
+        updateVisualizations(source, visible ? &status->debug() : NULL);
     }
+    m_visualizationsUpdated.clear();
+
+    m_rendererItems[FieldRenderer::Background]->update();
+    m_rendererItems[FieldRenderer::Foreground]->update();
 }
 
-void FieldWidget::updateVisualizations(const amun::DebugValues &v)
+void FieldWidget::updateVisualizations(int source, const amun::DebugValues *v)
 {
-    // use introspection to iterate through the visualizations
-    const google::protobuf::RepeatedPtrField<amun::Visualization> &viss = v.visualization();
-    for (google::protobuf::RepeatedPtrField<amun::Visualization>::const_iterator it = viss.begin(); it != viss.end(); it++) {
-        const amun::Visualization &vis = *it;
-        // only draw visible visualizations
-        if (!m_visibleVisualizations.contains(QString::fromStdString(vis.name()))) {
-            continue;
+    // the batch of a source is identified by the source id
+    // unchanged visualizations keep their tesselation
+    m_renderer->beginBatch(source);
+
+    QPolygonF points;
+    const int size = (v) ? v->visualization_size() : 0;
+    for (int i = 0; i < size; i++) {
+        const amun::Visualization &vis = v->visualization(i);
+        // the key only references the name until it is inserted
+        const QByteArray name = QByteArray::fromRawData(vis.name().data(), vis.name().size());
+        QHash<QByteArray, bool>::const_iterator visible = m_visualizationVisible.constFind(name);
+        if (visible == m_visualizationVisible.constEnd()) {
+            visible = m_visualizationVisible.insert(QByteArray(name.constData(), name.size()),
+                    m_visibleVisualizations.contains(QString::fromStdString(vis.name())));
         }
 
-        QPen pen = Qt::NoPen;
-        QBrush brush = Qt::NoBrush;
-        // setup pen style and color
-        if (vis.has_pen()) {
-            pen.setStyle(Qt::SolidLine);
-
-            if (vis.pen().has_style()) {
-                switch (vis.pen().style()) {
-                case amun::Pen::DashLine:
-                    pen.setStyle(Qt::DashLine);
-                    break;
-
-                case amun::Pen::DotLine:
-                    pen.setStyle(Qt::DotLine);
-                    break;
-
-                case amun::Pen::DashDotLine:
-                    pen.setStyle(Qt::DashDotLine);
-                    break;
-
-                case amun::Pen::DashDotDotLine:
-                    pen.setStyle(Qt::DashDotDotLine);
-                    break;
-                }
-            }
-            if (vis.pen().has_color()) {
-                pen.setColor(QColor(
-                                 vis.pen().color().red(),
-                                 vis.pen().color().green(),
-                                 vis.pen().color().blue(),
-                                 vis.pen().color().alpha()));
-            }
-            if (vis.has_width()) {
-                pen.setWidthF(vis.width());
-            } else {
-                pen.setWidthF(0.01f);
-            }
+        // only draw visible visualizations
+        if (!visible.value()) {
+            continue;
         }
 
-        // configure brush
-        if (vis.has_brush()) {
-            brush = QBrush(QColor(vis.brush().red(), vis.brush().green(), vis.brush().blue(), vis.brush().alpha()));
-        }
+        const QPen pen = visualizationPen(vis);
+        const QBrush brush = visualizationBrush(vis);
+        const FieldRenderer::Layer layer = vis.background() ? FieldRenderer::Background : FieldRenderer::Foreground;
 
         if (vis.has_circle()) {
-            m_visualizationItems << createCircle(pen, brush, vis);
+            const QPointF center(vis.circle().p_x(), vis.circle().p_y());
+            m_renderer->addCircle(source, layer, center, vis.circle().radius(), pen, brush);
         }
 
         if (vis.has_polygon()) {
-            m_visualizationItems << createPolygon(pen, brush, vis);
+            const amun::Polygon &polygon = vis.polygon();
+            points.resize(polygon.point_size());
+            for (int j = 0; j < polygon.point_size(); j++) {
+                points[j] = QPointF(polygon.point(j).x(), polygon.point(j).y());
+            }
+            m_renderer->addPolygon(source, layer, points, pen, brush);
         }
 
         if (vis.has_path() && vis.path().point_size() > 1) {
-            m_visualizationItems << createPath(pen, brush, vis);
+            const amun::Path &path = vis.path();
+            points.resize(path.point_size());
+            for (int j = 0; j < path.point_size(); j++) {
+                points[j] = QPointF(path.point(j).x(), path.point(j).y());
+            }
+            m_renderer->addPath(source, layer, points, pen, brush);
         }
     }
+    m_renderer->endBatch(source);
 }
 
-QGraphicsItem* FieldWidget::createCircle(const QPen &pen, const QBrush &brush, const amun::Visualization &vis)
+QPen FieldWidget::visualizationPen(const amun::Visualization &vis)
 {
-    QGraphicsEllipseItem *item = new QGraphicsEllipseItem;
-    item->setPen(pen);
-    item->setBrush(brush);
+    if (!vis.has_pen()) {
+        return Qt::NoPen;
+    }
+
+    const amun::Pen &p = vis.pen();
+    const amun::Color &c = p.color();
+    const quint32 rgba = (c.red() << 24) | (c.green() << 16) | (c.blue() << 8) | c.alpha();
+    const float width = (vis.has_width()) ? vis.width() : 0.01f;
+    quint32 widthBits;
+    memcpy(&widthBits, &width, sizeof(widthBits));
+    const quint64 style = ((p.has_style()) ? p.style() : 0) * 2 + (p.has_color() ? 1 : 0);
+    const QPair<quint64, quint32> key((quint64(rgba) << 32) | style, widthBits);
+
+    QHash<QPair<quint64, quint32>, QPen>::const_iterator it = m_penCache.constFind(key);
+    if (it != m_penCache.constEnd()) {
+        return it.value();
+    }
+
+    // setup pen style and color
+    QPen pen(Qt::SolidLine);
+    if (p.has_style()) {
+        switch (p.style()) {
+        case amun::Pen::DashLine:
+            pen.setStyle(Qt::DashLine);
+            break;
 
-    float r = vis.circle().radius();
-    QRectF rect;
-    rect.setWidth(2 * r);
-    rect.setHeight(2 * r);
-    rect.moveCenter(QPointF(vis.circle().p_x(), vis.circle().p_y()));
-    item->setRect(rect);
-    item->setZValue(vis.background() ? 1.0f : 10.0f);
-    m_scene->addItem(item);
-    return item;
-}
+        case amun::Pen::DotLine:
+            pen.setStyle(Qt::DotLine);
+            break;
 
-QGraphicsItem* FieldWidget::createPolygon(const QPen &pen, const QBrush &brush, const amun::Visualization &vis)
-{
-    QGraphicsPolygonItem *item = new QGraphicsPolygonItem;
-    item->setPen(pen);
-    item->setBrush(brush);
+        case amun::Pen::DashDotLine:
+            pen.setStyle(Qt::DashDotLine);
+            break;
 
-    QPolygonF polygon;
-    const google::protobuf::RepeatedPtrField<amun::Point> &pts = vis.polygon().point();
-    for (google::protobuf::RepeatedPtrField<amun::Point>::const_iterator it = pts.begin(); it != pts.end(); it++) {
-        const amun::Point &point = *it;
-        polygon.append(QPointF(point.x(), point.y()));
+        case amun::Pen::DashDotDotLine:
+            pen.setStyle(Qt::DashDotDotLine);
+            break;
+        }
+    }
+    if (p.has_color()) {
+        pen.setColor(QColor(c.red(), c.green(), c.blue(), c.alpha()));
     }
+    pen.setWidthF(width);
 
-    item->setPolygon(polygon);
-    item->setZValue(vis.background() ? 1.0f : 10.0f);
-    m_scene->addItem(item);
-    return item;
+    m_penCache.insert(key, pen);
+    return pen;
 }
 
-QGraphicsItem* FieldWidget::createPath(const QPen &pen, const QBrush &brush, const amun::Visualization &vis)
+QBrush FieldWidget::visualizationBrush(const amun::Visualization &vis)
 {
-    QGraphicsPathItem *item = new QGraphicsPathItem;
-    item->setPen(pen);
-    item->setBrush(brush);
+    if (!vis.has_brush()) {
+        return Qt::NoBrush;
+    }
 
-    QPainterPath path;
-    path.moveTo(vis.path().point(0).x(), vis.path().point(0).y());
-    for (int i = 1; i < vis.path().point_size(); i++) {
-        path.lineTo(vis.path().point(i).x(), vis.path().point(i).y());
+    const amun::Color &c = vis.brush();
+    const quint32 rgba = (c.red() << 24) | (c.green() << 16) | (c.blue() << 8) | c.alpha();
+    QHash<quint32, QBrush>::const_iterator it = m_brushCache.constFind(rgba);
+    if (it != m_brushCache.constEnd()) {
+        return it.value();
     }
 
-    item->setPath(path);
-    item->setZValue(vis.background() ? 1.0f : 10.0f);
-    m_scene->addItem(item);
-    return item;
+    const QBrush brush(QColor(c.red(), c.green(), c.blue(), c.alpha()));
+    m_brushCache.insert(rgba, brush);
+    return brush;
 }
 
 void FieldWidget::clearBallTraces()
@@ -543,11 +571,22 @@ void FieldWidget::clearTraces()
 
 void FieldWidget::clearTrace(Trace &trace)
 {
-    for (QGraphicsEllipseItem *item: trace.traces) {
-        item->hide();
-        trace.invalid.append(item);
-    }
     trace.traces.clear();
+    trace.rebuild = true;
+}
+
+void FieldWidget::removeTrace(Trace &trace, QMultiMap<qint64, QPointF>::iterator &it)
+{
+    if (trace.drawn > 0) {
+        if (it == trace.traces.begin()) {
+            // dropping the oldest point doesn't affect the other ones
+            trace.drawn--;
+            trace.removed++;
+        } else if (it.key() <= trace.lastDrawnTime) {
+            trace.rebuild = true;
+        }
+    }
+    it = trace.traces.erase(it);
 }
 
 void FieldWidget::invalidateTraces(Trace &trace, qint64 time)
@@ -558,49 +597,70 @@ void FieldWidget::invalidateTraces(Trace &trace, qint64 time)
             continue;
         }
 
-        QGraphicsEllipseItem *item = it.value();
-        item->hide();
-        it = trace.traces.erase(it);
-        trace.invalid.append(item);
+        removeTrace(trace, it);
     }
 }
 
 void FieldWidget::addTrace(Trace &trace, const QPointF &pos, qint64 time)
 {
-    QGraphicsEllipseItem *item = nullptr;
-    if (!trace.invalid.isEmpty()) {
-        item = trace.invalid.takeFirst();
-        item->show();
-    } else if (trace.traces.size() >= 1000) {
-        auto firstIt = trace.traces.begin();
-        item = firstIt.value();
-        trace.traces.erase(firstIt);
+    if (trace.traces.size() >= 1000) {
+        auto it = trace.traces.begin();
+        removeTrace(trace, it);
+    }
+    // points are only appended to the renderer, older ones require redrawing the trace
+    if (trace.drawn > 0 && time <= trace.lastDrawnTime) {
+        trace.rebuild = true;
+    }
+    trace.traces.insertMulti(time, pos);
+}
+
+void FieldWidget::updateTraces()
+{
+    updateTrace(m_ballTrace);
+    updateTrace(m_ballRawTrace);
+    updateTrace(m_robotYellowTrace);
+    updateTrace(m_robotYellowRawTrace);
+    updateTrace(m_robotBlueTrace);
+    updateTrace(m_robotBlueRawTrace);
+}
+
+void FieldWidget::updateTrace(Trace &trace)
+{
+    if (!trace.rebuild && trace.removed == 0 && trace.drawn == trace.traces.size()) {
+        return;
+    }
+
+    if (trace.rebuild) {
+        m_renderer->clear(trace.batch);
+        trace.drawn = 0;
+        trace.rebuild = false;
     } else {
-        item = new QGraphicsEllipseItem;
-        item->setPen(Qt::NoPen);
-        item->setBrush(trace.color);
-        item->setRect(QRectF(-0.015f, -0.015f, 0.03f, 0.03f));
-        item->setZValue(trace.z_index);
-        m_scene->addItem(item);
-        // cache after adding to scene
+        m_renderer->removeFirst(trace.batch, FieldRenderer::Traces, trace.removed);
     }
+    trace.removed = 0;
 
-    item->setPos(pos);
-    trace.traces.insertMulti(time, item);
+    // only add the points which are new since the last update
+    const QBrush brush(trace.color);
+    auto it = trace.traces.end() - (trace.traces.size() - trace.drawn);
+    for (; it != trace.traces.end(); ++it) {
+        m_renderer->addCircle(trace.batch, FieldRenderer::Traces, it.value(), 0.015f, Qt::NoPen, brush);
+        trace.lastDrawnTime = it.key();
+    }
+    trace.drawn = trace.traces.size();
+    m_rendererItems[FieldRenderer::Traces]->update();
 }
 
 void FieldWidget::updateDetection()
 {
-    if (m_worldState.isEmpty()) {
+    // prevent applying the world state again
+    const QList<Status> states = m_worldState.take();
+    if (states.isEmpty()) {
         return;
     }
 
-    for (int k = 0; k < m_worldState.size(); ++k) {
-        if (m_worldState[k].isNull()) {
-            continue;
-        }
-        const world::State &worldState = m_worldState[k]->world_state();
-        const bool isLast = (k == (m_worldState.size() - 1));
+    for (int k = 0; k < states.size(); ++k) {
+        const world::State &worldState = states[k]->world_state();
+        const bool isLast = (k == (states.size() - 1));
 
         if (worldState.has_ball()) {
             if (isLast) {
@@ -639,9 +699,6 @@ void FieldWidget::updateDetection()
     for(RobotMap::iterator it = m_robotsYellow.begin(); it != m_robotsYellow.end(); ++it) {
         it.value().tryHide();
     }
-
-    // prevent applying the world state again
-    m_worldState.clear();
 }
 
 void FieldWidget::setBall(const world::Ball &ball)
@@ -823,7 +880,9 @@ void FieldWidget::setFieldOrientation(float rotation)
     }
     m_robotsYellow.clear();
     // recreate robots on redraw
-    m_worldState.append(m_lastWorldState);
+    if (!m_worldState.latest().isNull()) {
+        m_worldState.push(m_worldState.latest());
+    }
     m_guiTimer->requestTriggering();
 }
 
@@ -853,8 +912,20 @@ void FieldWidget::setAntialiasing(bool enable)
     resetCachedContent();
 }
 
+void FieldWidget::makeGLCurrent()
+{
+    QGLWidget *glWidget = qobject_cast<QGLWidget *>(viewport());
+    if (glWidget) {
+        glWidget->makeCurrent();
+    }
+}
+
 void FieldWidget::setOpenGL(bool enable)
 {
+    // release resources while the old context still exists
+    makeGLCurrent();
+    m_renderer->resetGL();
+
     if (enable) {
         QGLFormat format;
         format.setSampleBuffers(true);
@@ -1381,10 +1452,10 @@ void FieldWidget::takeScreenshot()
 
 void FieldWidget::saveSituation()
 {
-    if (m_lastWorldState.isNull()) {
+    if (m_worldState.latest().isNull()) {
         return;
     }
-    ::saveSituation(m_lastWorldState->world_state(), m_gameState);
+    ::saveSituation(m_worldState.latest()->world_state(), m_gameState);
 }
 
 void FieldWidget::Robot::tryHide()
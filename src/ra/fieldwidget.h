@@ -21,12 +21,15 @@
 #ifndef FIELDWIDGET_H
 #define FIELDWIDGET_H
 
+#include "fieldrenderer.h"
 #include "protobuf/command.h"
 #include "protobuf/status.h"
+#include "statusinbox.h"
 #include <QGraphicsView>
 #include <QMap>
 #include <QHash>
-#include <QLinkedList>
+#include <QPen>
+#include <QSet>
 
 class GuiTimer;
 class QLabel;
@@ -51,10 +54,17 @@ private:
 
     struct Trace
     {
-        QMultiMap<qint64, QGraphicsEllipseItem *> traces;
-        QLinkedList<QGraphicsEllipseItem *> invalid;
+        Trace() : batch(0), drawn(0), removed(0), lastDrawnTime(0), rebuild(false) {}
+        QMultiMap<qint64, QPointF> traces;
         QColor color;
-        float z_index;
+        // batch of the field renderer, raw traces use lower values to be drawn first
+        int batch;
+        // the renderer holds the first drawn points of traces, minus the removed oldest ones
+        int drawn;
+        int removed;
+        qint64 lastDrawnTime;
+        // a drawn point other than the oldest one has changed
+        bool rebuild;
     };
 
     typedef QMap<uint, Robot> RobotMap;
@@ -76,6 +86,7 @@ public:
     ~FieldWidget() override;
 
     void setLogplayer();
+    const StatusInbox &worldStateInbox() const { return m_worldState; }
 
 signals:
     void sendCommand(const Command &command);
@@ -121,7 +132,8 @@ private:
     void updateGeometry();
     void updateInfoText();
     void updateVisualizations();
-    void updateVisualizations(const amun::DebugValues &v);
+    void updateVisualizations(int source, const amun::DebugValues *v);
+    void invalidateVisualizations();
     void clearTeamData(RobotMap &team);
     void updateTeam(RobotMap &team, QHash<uint, robot::Specs> &specsMap, const robot::Team &specs);
     void setBall(const world::Ball &ball);
@@ -133,15 +145,18 @@ private:
     void sendSimulatorMoveCommand(const QPointF &p);
     void drawLines(QPainter *painter, QRectF rect, bool cosmetic);
     void drawGoal(QPainter *painter, float side, bool cosmetic);
-    QGraphicsItem* createCircle(const QPen &pen, const QBrush &brush, const amun::Visualization &vis);
-    QGraphicsItem* createPolygon(const QPen &pen, const QBrush &brush, const amun::Visualization &vis);
-    QGraphicsItem* createPath(const QPen &pen, const QBrush &brush, const amun::Visualization &vis);
+    QPen visualizationPen(const amun::Visualization &vis);
+    QBrush visualizationBrush(const amun::Visualization &vis);
+    void makeGLCurrent();
 
     void invalidateTraces(Trace &trace, qint64 time);
     void addTrace(Trace &trace, const QPointF &pos, qint64 time);
     void clearTrace(Trace &trace);
+    void removeTrace(Trace &trace, QMultiMap<qint64, QPointF>::iterator &it);
     void clearBallTraces();
     void clearRobotTraces();
+    void updateTraces();
+    void updateTrace(Trace &trace);
 
 private:
     QGraphicsScene *m_scene;
@@ -166,18 +181,23 @@ private:
 
     QHash<uint, robot::Specs> m_teamBlue;
     QHash<uint, robot::Specs> m_teamYellow;
-    QList<Status> m_worldState;
-    Status m_lastWorldState;
+    // world states received since the last redraw
+    StatusInbox m_worldState;
     QMap<int, bool> m_visibleVisSources;
     // save status to avoid copying the debug values
     QMap<int, Status> m_visualizations;
-    bool m_visualizationsUpdated;
+    // sources whose visualizations have to be diffed against the scene
+    QSet<int> m_visualizationsUpdated;
     amun::GameState m_gameState;
 
     QGraphicsEllipseItem *m_ball;
     QStringList m_visibleVisualizations;
-    typedef QList<QGraphicsItem*> Items;
-    Items m_visualizationItems;
+    // cached visibility by visualization name
+    QHash<QByteArray, bool> m_visualizationVisible;
+    FieldRenderer *m_renderer;
+    FieldRendererItem *m_rendererItems[FieldRenderer::LayerCount];
+    QHash<QPair<quint64, quint32>, QPen> m_penCache;
+    QHash<quint32, QBrush> m_brushCache;
     RobotMap m_robotsBlue;
     RobotMap m_robotsYellow;
 
@@ -20,12 +20,22 @@
 
 #include "guitimer.h"
 #include "core/timer.h"
+#include <QAbstractScrollArea>
+#include <QCoreApplication>
+#include <QEvent>
 #include <QTimer>
+#include <QVarLengthArray>
+#include <QWidget>
 
-GuiTimerBase::GuiTimerBase(QObject *parent) : QObject(parent), m_isActive(false), m_baseInterval(30)
+// upper limit for the interval multiplier of background widgets
+static const int MAX_SLOWDOWN = 4;
+
+GuiTimerBase::GuiTimerBase(QObject *parent) : QObject(parent), m_isActive(false), m_baseInterval(16),
+        m_budget(10 * 1000 * 1000), m_paintTime(0), m_isPainting(false)
 {
     m_timer = new QTimer(parent);
     m_timer->setInterval(m_baseInterval);
+    m_timer->setTimerType(Qt::PreciseTimer);
     m_timer->setSingleShot(false);
     connect(m_timer, &QTimer::timeout, this, &GuiTimerBase::handleTimeout);
 }
@@ -39,11 +49,43 @@ GuiTimerBase * GuiTimerBase::instance()
 void GuiTimerBase::requestTriggering()
 {
     if (!m_timer->isActive()) {
+        // painting while idle doesn't count towards the next tick
+        m_paintTime = 0;
         m_timer->start();
     }
     m_isActive = true;
 }
 
+void GuiTimerBase::registerTimer(GuiTimer *timer)
+{
+    m_timers.append(timer);
+}
+
+void GuiTimerBase::unregisterTimer(GuiTimer *timer)
+{
+    m_timers.removeOne(timer);
+}
+
+void GuiTimerBase::watchPaintEvents(QWidget *widget)
+{
+    widget->installEventFilter(this);
+}
+
+bool GuiTimerBase::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() != QEvent::Paint || m_isPainting) {
+        return false;
+    }
+
+    // deliver the paint event right away to measure how long it takes
+    m_isPainting = true;
+    const qint64 startTime = Timer::systemTime();
+    QCoreApplication::sendEvent(watched, event);
+    m_paintTime += Timer::systemTime() - startTime;
+    m_isPainting = false;
+    return true;
+}
+
 void GuiTimerBase::handleTimeout()
 {
     if (!m_isActive) {
@@ -51,14 +93,58 @@ void GuiTimerBase::handleTimeout()
         m_timer->stop();
     }
     m_isActive = false;
-    emit timeout();
+
+    const qint64 curTime = Timer::systemTime() / (1000*1000);
+    // the widgets were painted since the last tick, count that as part of this tick
+    const qint64 startTime = Timer::systemTime() - m_paintTime;
+    m_paintTime = 0;
+
+    // timers may be deleted by the callbacks of other timers
+    QVarLengthArray<QPointer<GuiTimer>, 32> timers[3];
+    foreach (GuiTimer *timer, m_timers) {
+        if (timer->m_isActive) {
+            timers[timer->priority()].append(timer);
+        }
+    }
+
+    // run the timers of the focused widgets first, others are deferred once the budget is used up
+    bool overBudget = Timer::systemTime() - startTime > m_budget;
+    for (int priority = GuiTimer::Focused; priority <= GuiTimer::Hidden; priority++) {
+        for (const QPointer<GuiTimer> &timer : timers[priority]) {
+            if (timer.isNull() || !timer->m_isActive) {
+                continue;
+            }
+            if (!timer->isDue(curTime)) {
+                // keep timer active
+                requestTriggering();
+            } else if (overBudget && priority != GuiTimer::Focused) {
+                timer->defer(curTime);
+                requestTriggering();
+            } else {
+                timer->trigger();
+                overBudget = Timer::systemTime() - startTime > m_budget;
+            }
+        }
+    }
+
+    // speed up background widgets again once there's enough time left
+    if (Timer::systemTime() - startTime < m_budget / 2) {
+        foreach (GuiTimer *timer, m_timers) {
+            timer->relax();
+        }
+    }
 }
 
 
 GuiTimer::GuiTimer(int interval, QObject *parent) : QObject(parent), m_isActive(false),
-         m_interval(interval), m_nextTriggerTime(0)
+         m_interval(interval), m_nextTriggerTime(0), m_slowdown(1)
 {
-    connect(GuiTimerBase::instance(), &GuiTimerBase::timeout, this, &GuiTimer::handleTimeout);
+    GuiTimerBase::instance()->registerTimer(this);
+}
+
+GuiTimer::~GuiTimer()
+{
+    GuiTimerBase::instance()->unregisterTimer(this);
 }
 
 void GuiTimer::requestTriggering()
@@ -74,19 +160,68 @@ void GuiTimer::requestTriggering()
     GuiTimerBase::instance()->requestTriggering();
 }
 
-void GuiTimer::handleTimeout()
+QWidget *GuiTimer::widget() const
 {
-    if (!m_isActive) {
-        return;
+    // the timer belongs to the widget it was created for
+    QObject *object = parent();
+    while (object != nullptr && !object->isWidgetType()) {
+        object = object->parent();
+    }
+    return static_cast<QWidget *>(object);
+}
+
+GuiTimer::Priority GuiTimer::priority() const
+{
+    const QWidget *widget = this->widget();
+    if (widget == nullptr || !widget->isVisible()) {
+        return Hidden;
     }
+    return (widget->isActiveWindow()) ? Focused : Visible;
+}
+
+bool GuiTimer::isDue(qint64 curTime) const
+{
     // allow a small timeout error
-    if (Timer::systemTime() / (1000*1000) >= m_nextTriggerTime - 1) {
-        // preset trigger time to keep interval constant
-        m_nextTriggerTime += m_interval;
-        m_isActive = false;
-        emit timeout();
-    } else {
-        // keep timer active
-        GuiTimerBase::instance()->requestTriggering();
+    return curTime >= m_nextTriggerTime - 1;
+}
+
+void GuiTimer::trigger()
+{
+    // preset trigger time to keep interval constant
+    // background widgets run slower while the gui is under load
+    const int slowdown = (priority() == Focused) ? 1 : m_slowdown;
+    m_nextTriggerTime += m_interval * slowdown;
+    m_isActive = false;
+    emit timeout();
+    watchPaintEvents();
+}
+
+void GuiTimer::watchPaintEvents()
+{
+    // the widget usually repaints as a result of the timeout
+    QWidget *widget = this->widget();
+    if (widget == nullptr) {
+        return;
+    }
+    if (m_watchedWidget != widget) {
+        GuiTimerBase::instance()->watchPaintEvents(widget);
+        m_watchedWidget = widget;
+    }
+    // scroll areas paint into their viewport, which may be replaced at any time
+    QAbstractScrollArea *scrollArea = qobject_cast<QAbstractScrollArea *>(widget);
+    if (scrollArea != nullptr && m_watchedViewport != scrollArea->viewport()) {
+        GuiTimerBase::instance()->watchPaintEvents(scrollArea->viewport());
+        m_watchedViewport = scrollArea->viewport();
     }
 }
+
+void GuiTimer::defer(qint64 curTime)
+{
+    m_slowdown = qMin(m_slowdown * 2, MAX_SLOWDOWN);
+    m_nextTriggerTime = curTime + m_interval * m_slowdown;
+}
+
+void GuiTimer::relax()
+{
+    m_slowdown = qMax(m_slowdown / 2, 1);
+}
@@ -21,11 +21,15 @@
 #ifndef GUITIMER_H
 #define GUITIMER_H
 
+#include <QList>
 #include <QObject>
+#include <QPointer>
 
 class QTimer;
+class QWidget;
 class GuiTimer;
 
+//! Shared frame tick for all gui timers, runs the due timers within a time budget
 class GuiTimerBase : public QObject
 {
     Q_OBJECT
@@ -35,36 +39,63 @@ private:
 
     explicit GuiTimerBase(QObject *parent = 0);
     void requestTriggering();
+    void registerTimer(GuiTimer *timer);
+    void unregisterTimer(GuiTimer *timer);
+    void watchPaintEvents(QWidget *widget);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private slots:
     void handleTimeout();
 
-signals:
-    void timeout();
-
 private:
     QTimer *m_timer;
     bool m_isActive;
     const int m_baseInterval;
+    // maximum time spent in timer callbacks and painting per tick, in ns
+    const qint64 m_budget;
+    // time spent painting the widgets of the timers since the last tick, in ns
+    qint64 m_paintTime;
+    bool m_isPainting;
+    QList<GuiTimer*> m_timers;
 };
 
 class GuiTimer : public QObject
 {
     Q_OBJECT
+    friend class GuiTimerBase;
 public:
     explicit GuiTimer(int interval, QObject *parent = 0);
+    ~GuiTimer() override;
     void requestTriggering();
 
-private slots:
-    void handleTimeout();
-
 signals:
     void timeout();
 
+private:
+    enum Priority {
+        Focused = 0, // visible in the active window
+        Visible = 1,
+        Hidden = 2
+    };
+
+    QWidget *widget() const;
+    Priority priority() const;
+    bool isDue(qint64 curTime) const;
+    void trigger();
+    void watchPaintEvents();
+    void defer(qint64 curTime);
+    void relax();
+
 private:
     bool m_isActive;
     const int m_interval;
     qint64 m_nextTriggerTime;
+    // interval multiplier for timers of background widgets under load
+    int m_slowdown;
+    QPointer<QWidget> m_watchedWidget;
+    QPointer<QWidget> m_watchedViewport;
 };
 
 
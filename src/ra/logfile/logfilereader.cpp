@@ -19,9 +19,12 @@
  ***************************************************************************/
 
 #include "logfilereader.h"
+#include "logfilewriter.h"
+#include "statuskeyframe.h"
 
 #include <QMutex>
 #include <QMutexLocker>
+#include <algorithm>
 
 LogFileReader::LogFileReader() :
     QObject(), m_stream(&m_file)
@@ -62,17 +65,27 @@ bool LogFileReader::open(const QString &filename)
         const qint64 offset = m_file.pos();
 
         qint64 time;
+        bool isKeyframe = false;
         if (m_version == Version0) {
             time = readTimestampVersion0();
         } else if (m_version == Version1) {
             time = readTimestampVersion1();
+        } else if (m_version == Version2) {
+            time = readTimestampVersion2(&isKeyframe);
         } else {
             // internal bugcheck
             qFatal("This log format is not yet implemented!");
         }
 
-        // a timestamp of 0 indicates a invalid packet
-        if (time != 0) {
+        if (isKeyframe) {
+            // consecutive keyframe packets form a single keyframe
+            if (m_keyframes.isEmpty() || m_keyframes.last().packet != m_packets.size()) {
+                Keyframe keyframe;
+                keyframe.packet = m_packets.size();
+                m_keyframes.append(keyframe);
+            }
+            m_keyframes.last().offsets.append(offset);
+        } else if (time != 0) { // a timestamp of 0 indicates a invalid packet
             // remember the start of the current frame
             m_packets.append(offset);
             m_timings.append(time);
@@ -96,6 +109,10 @@ void LogFileReader::close()
     m_errorMsg.clear();
     m_packets.clear();
     m_timings.clear();
+    m_keyframes.clear();
+
+    m_decoder.reset();
+    m_lastDecodedPacket = -1;
 }
 
 bool LogFileReader::readVersion()
@@ -113,6 +130,10 @@ bool LogFileReader::readVersion()
             m_version = Version1;
             break;
 
+        case 2:
+            m_version = Version2;
+            break;
+
         default:
             m_errorMsg = "File format not supported!";
             return false;
@@ -153,6 +174,14 @@ qint64 LogFileReader::readTimestampVersion1()
     return time;
 }
 
+qint64 LogFileReader::readTimestampVersion2(bool *isKeyframe)
+{
+    quint8 type;
+    m_stream >> type;
+    *isKeyframe = (type == LogFileWriter::KeyframePacket);
+    return readTimestampVersion1();
+}
+
 Status LogFileReader::readStatus(int packetNum)
 {
     // lock to prevent intermediate file changes
@@ -160,12 +189,49 @@ Status LogFileReader::readStatus(int packetNum)
     if (packetNum < 0 || packetNum >= m_packets.size()) {
         return Status();
     }
+    if (m_version != Version2) {
+        return readStatusAt(m_packets.value(packetNum));
+    }
 
+    // delta encoded packets depend on every packet since the last keyframe
+    if (packetNum != m_lastDecodedPacket + 1) {
+        const int keyframe = findKeyframe(packetNum);
+        int startPacket = (keyframe >= 0) ? m_keyframes.at(keyframe).packet : 0;
+        if (m_lastDecodedPacket >= 0 && packetNum > m_lastDecodedPacket && startPacket <= m_lastDecodedPacket + 1) {
+            // seeking forward in the same keyframe interval, continue from the last decoded packet
+            startPacket = m_lastDecodedPacket + 1;
+        } else {
+            m_decoder.reset();
+        }
+        for (int i = startPacket; i < packetNum; ++i) {
+            Status status = readStatusAt(m_packets.value(i));
+            if (!status.isNull()) {
+                m_decoder.decode(status.data());
+            }
+        }
+    }
+    m_lastDecodedPacket = packetNum;
+
+    Status status = readStatusAt(m_packets.value(packetNum));
+    if (!status.isNull() && !m_decoder.decode(status.data())) {
+        return Status();
+    }
+    return status;
+}
+
+Status LogFileReader::readStatusAt(qint64 offset)
+{
     // seek to the requested packet
-    m_file.seek(m_packets.value(packetNum));
+    m_file.seek(offset);
+
+    // skip packet type of version two
+    if (m_version == Version2) {
+        quint8 type;
+        m_stream >> type;
+    }
 
-    // skip timestamp of version one
-    if (m_version == Version1) {
+    // skip timestamp of version one and two
+    if (m_version == Version1 || m_version == Version2) {
         qint64 time;
         m_stream >> time;
     }
@@ -192,3 +258,63 @@ void LogFileReader::readPackets(int startPacket, int count)
         emit gotStatus(i, readStatus(i));
     }
 }
+
+int LogFileReader::findKeyframe(int packet) const
+{
+    QMutexLocker locker(m_mutex);
+    // binary search for the last keyframe before or at the packet
+    int lower = 0;
+    int upper = m_keyframes.size();
+    while (lower < upper) {
+        const int mid = (lower + upper) / 2;
+        if (m_keyframes.at(mid).packet <= packet) {
+            lower = mid + 1;
+        } else {
+            upper = mid;
+        }
+    }
+    return lower - 1;
+}
+
+int LogFileReader::keyframePacket(int keyframe) const
+{
+    QMutexLocker locker(m_mutex);
+    if (keyframe < 0 || keyframe >= m_keyframes.size()) {
+        return -1;
+    }
+    return m_keyframes.at(keyframe).packet;
+}
+
+/*!
+ * \brief Seek to a packet without emitting the packets leading to it
+ *
+ * The state of the keyframe, if any, and of the packets from startPacket up to
+ * the requested packet is accumulated. It is emitted as a few gotState signals,
+ * followed by the packet itself.
+ */
+void LogFileReader::seekPacket(int keyframe, int startPacket, int packet)
+{
+    QMutexLocker locker(m_mutex);
+    StatusKeyframe state;
+    if (keyframe >= 0 && keyframe < m_keyframes.size()) {
+        foreach (qint64 offset, m_keyframes.at(keyframe).offsets) {
+            const Status status = readStatusAt(offset);
+            if (!status.isNull()) {
+                state.update(*status);
+            }
+        }
+    }
+    for (int i = std::max(0, startPacket); i < packet; ++i) {
+        const Status status = readStatus(i);
+        if (!status.isNull()) {
+            state.update(*status);
+        }
+    }
+
+    if (!state.isEmpty()) {
+        foreach (const Status &status, state.statuses(state.time())) {
+            emit gotState(packet - 1, status);
+        }
+    }
+    emit gotStatus(packet, readStatus(packet));
+}
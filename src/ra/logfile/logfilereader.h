@@ -22,6 +22,7 @@
 #define LOGFILEREADER_H
 
 #include "protobuf/status.h"
+#include "protobuf/statusdelta.h"
 #include <QObject>
 #include <QString>
 #include <QDataStream>
@@ -49,16 +50,26 @@ public:
     int packetCount() const { return m_packets.size(); }
     Status readStatus(int packet);
 
+    // keyframes hold the accumulated state before the packet they belong to
+    int keyframeCount() const { return m_keyframes.size(); }
+    int findKeyframe(int packet) const;
+    int keyframePacket(int keyframe) const;
+
 public slots:
     void readPackets(int startPacket, int count);
+    void seekPacket(int keyframe, int startPacket, int packet);
 
 signals:
     void gotStatus(int packet, const Status &status);
+    //! Accumulated state before a packet, emitted while seeking
+    void gotState(int packet, const Status &status);
 
 private:
     bool readVersion();
     qint64 readTimestampVersion0();
     qint64 readTimestampVersion1();
+    qint64 readTimestampVersion2(bool *isKeyframe);
+    Status readStatusAt(qint64 offset);
 
     mutable QMutex *m_mutex;
     QString m_errorMsg;
@@ -66,10 +77,19 @@ private:
     QFile m_file;
     QDataStream m_stream;
 
-    enum Version { Version0, Version1 };
+    struct Keyframe {
+        int packet;
+        QList<qint64> offsets;
+    };
+
+    enum Version { Version0, Version1, Version2 };
     Version m_version;
     QList<qint64> m_packets;
     QList<qint64> m_timings;
+    QList<Keyframe> m_keyframes;
+
+    StatusDeltaDecoder m_decoder;
+    int m_lastDecodedPacket;
 };
 
 #endif // LOGFILEREADER_H
@@ -23,7 +23,10 @@
 #include <QMutexLocker>
 
 LogFileWriter::LogFileWriter() :
-    QObject(), m_stream(&m_file)
+    QObject(), m_stream(&m_file),
+    m_keyframeInterval(1E9),
+    m_lastKeyframeTime(0),
+    m_lastTime(0)
 {
     m_mutex = new QMutex(QMutex::Recursive);
     // ensure compatibility across qt versions
@@ -49,7 +52,7 @@ bool LogFileWriter::open(const QString &filename)
 
     // write log header
     m_stream << QString("AMUN-RA LOG");
-    m_stream << (int) 1; // log file version
+    m_stream << (int) 2; // log file version
 
     return true;
 }
@@ -59,6 +62,17 @@ void LogFileWriter::close()
     // cleanup everything and close file
     QMutexLocker locker(m_mutex);
     m_file.close();
+
+    m_lastKeyframeTime = 0;
+    m_lastTime = 0;
+    m_keyframe.clear();
+    m_encoder.reset();
+}
+
+void LogFileWriter::setKeyframeInterval(qint64 interval)
+{
+    QMutexLocker locker(m_mutex);
+    m_keyframeInterval = interval;
 }
 
 bool LogFileWriter::writeStatus(const Status &status)
@@ -69,12 +83,51 @@ bool LogFileWriter::writeStatus(const Status &status)
         return false;
     }
 
+    // a keyframe contains the accumulated state before the following status,
+    // thus seeking only has to replay the packets after the keyframe
+    if (m_lastKeyframeTime == 0) {
+        m_lastKeyframeTime = status->time();
+    } else if (m_keyframeInterval > 0 && status->time() - m_lastKeyframeTime >= m_keyframeInterval) {
+        if (!writeKeyframe()) {
+            return false;
+        }
+        m_lastKeyframeTime = status->time();
+        // start a new delta chain, this allows decoding from the keyframe onwards
+        m_encoder.reset();
+    }
+
+    // world state and debug values are stored relative to the previous ones
+    amun::Status encoded;
+    m_encoder.encode(*status, &encoded);
+    if (!writePacket(StatusPacket, encoded)) {
+        return false;
+    }
+    m_keyframe.update(*status);
+    m_lastTime = status->time();
+    return true;
+}
+
+bool LogFileWriter::writePacket(PacketType type, const amun::Status &status)
+{
     QByteArray data;
-    data.resize(status->ByteSize());
-    if (status->SerializeToArray(data.data(), data.size())) {
-        m_stream << (qint64) status->time();
+    data.resize(status.ByteSize());
+    if (status.SerializeToArray(data.data(), data.size())) {
+        m_stream << (quint8) type;
+        m_stream << (qint64) status.time();
         m_stream << qCompress(data);
         return true;
     }
     return false;
 }
+
+bool LogFileWriter::writeKeyframe()
+{
+    // the keyframe consists of one status with the world, game and team state
+    // followed by one status per debug source
+    foreach (const Status &status, m_keyframe.statuses(m_lastTime)) {
+        if (!writePacket(KeyframePacket, *status)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -22,6 +22,8 @@
 #define LOGFILEWRITER_H
 
 #include "protobuf/status.h"
+#include "protobuf/statusdelta.h"
+#include "statuskeyframe.h"
 #include <QObject>
 #include <QString>
 #include <QDataStream>
@@ -33,6 +35,9 @@ class LogFileWriter : public QObject
 {
     Q_OBJECT
 public:
+    // record types of log file version 2
+    enum PacketType { StatusPacket = 0, KeyframePacket = 1 };
+
     explicit LogFileWriter();
     ~LogFileWriter() override;
 
@@ -42,13 +47,25 @@ public:
 
     QString filename() const { return m_file.fileName(); }
 
+    // interval in nanoseconds between two keyframes, 0 disables keyframes
+    void setKeyframeInterval(qint64 interval);
+
 public slots:
     bool writeStatus(const Status &status);
 
 private:
+    bool writePacket(PacketType type, const amun::Status &status);
+    bool writeKeyframe();
+
     mutable QMutex *m_mutex;
     QFile m_file;
     QDataStream m_stream;
+
+    qint64 m_keyframeInterval;
+    qint64 m_lastKeyframeTime;
+    qint64 m_lastTime;
+    StatusKeyframe m_keyframe;
+    StatusDeltaEncoder m_encoder;
 };
 
 #endif // LOGFILEWRITER_H
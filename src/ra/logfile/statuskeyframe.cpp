@@ -0,0 +1,113 @@
+/***************************************************************************
+ *   Copyright 2016 Robotics Erlangen e.V.                                 *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include "statuskeyframe.h"
+
+/*!
+ * \class StatusKeyframe
+ * \ingroup ra
+ * \brief Accumulated state of a status stream, as stored in log file keyframes
+ *
+ * Only the latest value of every part that is not contained in every status is
+ * kept. Log messages are dropped, these are only shown during continuous playback.
+ */
+
+StatusKeyframe::StatusKeyframe() :
+    m_time(0),
+    m_isEmpty(true)
+{
+}
+
+void StatusKeyframe::update(const amun::Status &status)
+{
+    m_time = status.time();
+    m_isEmpty = false;
+
+    if (status.has_game_state()) {
+        m_state.mutable_game_state()->CopyFrom(status.game_state());
+    }
+    if (status.has_world_state()) {
+        m_state.mutable_world_state()->CopyFrom(status.world_state());
+    }
+    if (status.has_geometry()) {
+        m_state.mutable_geometry()->CopyFrom(status.geometry());
+    }
+    if (status.has_team_blue()) {
+        m_state.mutable_team_blue()->CopyFrom(status.team_blue());
+    }
+    if (status.has_team_yellow()) {
+        m_state.mutable_team_yellow()->CopyFrom(status.team_yellow());
+    }
+    if (status.has_strategy_blue()) {
+        m_state.mutable_strategy_blue()->CopyFrom(status.strategy_blue());
+    }
+    if (status.has_strategy_yellow()) {
+        m_state.mutable_strategy_yellow()->CopyFrom(status.strategy_yellow());
+    }
+    if (status.has_strategy_autoref()) {
+        m_state.mutable_strategy_autoref()->CopyFrom(status.strategy_autoref());
+    }
+    if (status.has_timing()) {
+        // timings are split across several status
+        m_state.mutable_timing()->MergeFrom(status.timing());
+    }
+    if (status.radio_command_size() > 0) {
+        m_state.mutable_radio_command()->CopyFrom(status.radio_command());
+    }
+    if (status.has_transceiver()) {
+        m_state.mutable_transceiver()->CopyFrom(status.transceiver());
+    }
+    if (status.has_radio()) {
+        m_state.mutable_radio()->CopyFrom(status.radio());
+    }
+    if (status.has_debug()) {
+        amun::DebugValues &debug = m_debug[status.debug().source()];
+        debug.CopyFrom(status.debug());
+        debug.clear_log();
+    }
+}
+
+/*!
+ * \brief Returns the state as one status with the world, game and team state
+ * followed by one status per debug source
+ */
+QList<Status> StatusKeyframe::statuses(qint64 time) const
+{
+    QList<Status> result;
+    Status status(new amun::Status(m_state));
+    status->set_time(time);
+    result.append(status);
+
+    foreach (const amun::DebugValues &debug, m_debug) {
+        Status debugStatus(new amun::Status);
+        debugStatus->set_time(time);
+        debugStatus->mutable_debug()->CopyFrom(debug);
+        result.append(debugStatus);
+    }
+    return result;
+}
+
+void StatusKeyframe::clear()
+{
+    m_state.Clear();
+    m_debug.clear();
+    m_time = 0;
+    m_isEmpty = true;
+}
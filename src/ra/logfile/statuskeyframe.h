@@ -0,0 +1,50 @@
+/***************************************************************************
+ *   Copyright 2016 Robotics Erlangen e.V.                                 *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef STATUSKEYFRAME_H
+#define STATUSKEYFRAME_H
+
+#include "protobuf/status.h"
+#include <QList>
+#include <QMap>
+
+//! Accumulated state of a status stream, as stored in log file keyframes
+class StatusKeyframe
+{
+public:
+    StatusKeyframe();
+
+public:
+    void update(const amun::Status &status);
+    QList<Status> statuses(qint64 time) const;
+    void clear();
+
+    bool isEmpty() const { return m_isEmpty; }
+    //! Time of the last status passed to \ref update
+    qint64 time() const { return m_time; }
+
+private:
+    amun::Status m_state;
+    QMap<int, amun::DebugValues> m_debug;
+    qint64 m_time;
+    bool m_isEmpty;
+};
+
+#endif // STATUSKEYFRAME_H
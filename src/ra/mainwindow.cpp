@@ -35,14 +35,17 @@
 #include <QMetaType>
 #include <QSettings>
 #include <QThread>
+#include <QTimer>
 
-MainWindow::MainWindow(QWidget *parent) :
+MainWindow::MainWindow(const QString &remoteAddress, const amun::StatusSubscription &subscription, QWidget *parent) :
     QMainWindow(parent),
     ui(new Ui::MainWindow),
     m_transceiverActive(false),
     m_logFile(NULL),
     m_logFileThread(NULL),
     m_lastStageTime(0),
+    m_fieldDropped(0),
+    m_fieldCoalesced(0),
     m_logStartTime(0)
 {
     qRegisterMetaType<SSL_Referee::Command>("SSL_Referee::Command");
@@ -75,6 +78,14 @@ MainWindow::MainWindow(QWidget *parent) :
     statusBar()->addPermanentWidget(m_logTimeLabel);
     m_logTimeLabel->hide();
 
+    // only shown while the field widget can't keep up with the world states
+    m_fieldStatisticsLabel = new QLabel();
+    statusBar()->addPermanentWidget(m_fieldStatisticsLabel);
+    m_fieldStatisticsLabel->hide();
+    QTimer *fieldStatisticsTimer = new QTimer(this);
+    connect(fieldStatisticsTimer, &QTimer::timeout, this, &MainWindow::updateFieldStatistics);
+    fieldStatisticsTimer->start(1000);
+
     m_refereeStatus = new RefereeStatusWidget;
     statusBar()->addPermanentWidget(m_refereeStatus);
 
@@ -106,6 +117,7 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(m_configDialog, SIGNAL(sendCommand(Command)), SLOT(sendCommand(Command)));
 
     connect(ui->options, SIGNAL(sendCommand(Command)), SLOT(sendCommand(Command)));
+    connect(ui->visualization, SIGNAL(sendCommand(Command)), SLOT(sendCommand(Command)));
 
     // setup visualization only parts of the ui
     connect(ui->visualization, SIGNAL(itemsChanged(QStringList)), ui->field, SLOT(visualizationsChanged(QStringList)));
@@ -145,9 +157,14 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(this, SIGNAL(gotStatus(Status)), ui->log, SLOT(handleStatus(Status)));
     connect(this, SIGNAL(gotStatus(Status)), ui->options, SLOT(handleStatus(Status)));
 
-    // start amun
+    // start amun, or just show the status of a remote one
     connect(&m_amun, SIGNAL(gotStatus(Status)), SLOT(handleStatus(Status)));
-    m_amun.start();
+    if (remoteAddress.isEmpty()) {
+        m_amun.start();
+    } else {
+        m_amun.startRemote(remoteAddress, subscription);
+        setWindowTitle(windowTitle() + " - " + remoteAddress);
+    }
 
     // restore configuration and initialize everything
     ui->input->load();
@@ -293,6 +310,35 @@ void MainWindow::handleStatus(const Status &status)
     emit gotStatus(status);
 }
 
+void MainWindow::updateFieldStatistics()
+{
+    // statuses are coalesced on the way to the gui thread and again for the field
+    const StatusInbox &inbox = ui->field->worldStateInbox();
+    const quint64 totalDropped = m_amun.droppedStatus() + inbox.dropped();
+    const quint64 totalCoalesced = m_amun.coalescedStatus() + inbox.coalesced();
+    const quint64 dropped = totalDropped - m_fieldDropped;
+    const quint64 coalesced = totalCoalesced - m_fieldCoalesced;
+    m_fieldDropped = totalDropped;
+    m_fieldCoalesced = totalCoalesced;
+
+    if (dropped > 0) {
+        m_fieldStatisticsLabel->setText(QString("<font color=\"red\">GUI dropped %1 frames/s</font>").arg(dropped));
+        m_fieldStatisticsLabel->setToolTip(QString("%1 frames/s coalesced").arg(coalesced));
+        m_fieldStatisticsLabel->show();
+    } else {
+        m_fieldStatisticsLabel->hide();
+    }
+}
+
+void MainWindow::serveStatus(quint16 port)
+{
+    Command command(new amun::Command);
+    amun::CommandStatusServer *server = command->mutable_amun()->mutable_status_server();
+    server->set_enable(true);
+    server->set_port(port);
+    sendCommand(command);
+}
+
 void MainWindow::sendCommand(const Command &command)
 {
     m_amun.sendCommand(command);
@@ -395,7 +441,8 @@ void MainWindow::setRecording(bool record)
             delete m_logFile;
             return;
         }
-        connect(this, SIGNAL(gotStatus(Status)), m_logFile, SLOT(writeStatus(Status)));
+        // record every status, even if the gui coalesces some of them
+        connect(&m_amun, SIGNAL(gotStatusForLog(Status)), m_logFile, SLOT(writeStatus(Status)));
 
         // create thread if not done yet and move to seperate thread
         if (m_logFileThread == NULL) {
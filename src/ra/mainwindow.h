@@ -45,12 +45,17 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 
 public:
-    explicit MainWindow(QWidget *parent = 0);
+    explicit MainWindow(const QString &remoteAddress = QString(),
+                        const amun::StatusSubscription &subscription = amun::StatusSubscription(),
+                        QWidget *parent = 0);
     ~MainWindow() override;
 
 signals:
     void gotStatus(const Status &status);
 
+public:
+    void serveStatus(quint16 port);
+
 protected:
     void closeEvent(QCloseEvent *e) override;
 
@@ -65,6 +70,7 @@ private slots:
     void setRecording(bool record);
     void setCharge(bool charge);
     void showConfigDialog();
+    void updateFieldStatistics();
 
 private:
     void sendFlip();
@@ -87,6 +93,9 @@ private:
     qint64 m_lastTime;
     qint32 m_lastStageTime;
     QLabel *m_logTimeLabel;
+    QLabel *m_fieldStatisticsLabel;
+    quint64 m_fieldDropped;
+    quint64 m_fieldCoalesced;
     qint64 m_logStartTime;
     robot::Team m_yellowTeam;
     robot::Team m_blueTeam;
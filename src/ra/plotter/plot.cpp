@@ -19,17 +19,28 @@
  ***************************************************************************/
 
 #include "plot.h"
-#include <QGLWidget>
+
+// each pyramid level combines 1 << LEVEL_SHIFT buckets of the previous level
+static const int LEVEL_SHIFT = 2;
+// smallest number of buckets for the coarsest level
+static const int MIN_LEVEL_BUCKETS = 16;
 
 Plot::Plot(const QString &name, QObject *parent) :
     QObject(parent), // use QObject for garbage collection
     m_name(name),
     m_pos(0),
     m_count(0),
-    m_time(0)
+    m_time(0),
+    m_capacity(6000),
+    m_samples(0)
 {
     // ringbuffer with 6000 entrys as time, value pair
-    m_data.resize(6000 * 2);
+    m_data.resize(m_capacity * 2);
+
+    for (int level = 1; (m_capacity >> (LEVEL_SHIFT * level)) >= MIN_LEVEL_BUCKETS; level++) {
+        // two extra buckets for the partially filled ones at both ends
+        m_levels.append(QVector<Bucket>((m_capacity >> (LEVEL_SHIFT * level)) + 2));
+    }
 }
 
 void Plot::addPoint(float time, float value)
@@ -46,17 +57,91 @@ void Plot::addPoint(float time, float value)
     if (m_count < m_data.size()) {
         m_count += 2;
     }
+
+    // update the bucket containing the sample on each level
+    const quint64 sample = m_samples++;
+    for (int level = 1; level <= m_levels.size(); level++) {
+        const int shift = LEVEL_SHIFT * level;
+        QVector<Bucket> &buckets = m_levels[level - 1];
+        Bucket &bucket = buckets[(sample >> shift) % buckets.size()];
+        if ((sample & ((quint64(1) << shift) - 1)) == 0) {
+            bucket = { time, value, time, value };
+        } else {
+            if (value < bucket.vMin) {
+                bucket.tMin = time;
+                bucket.vMin = value;
+            }
+            if (value > bucket.vMax) {
+                bucket.tMax = time;
+                bucket.vMax = value;
+            }
+        }
+    }
 }
 
-void Plot::plot(const QColor &color) const
+// returns the first sample in [first, last) that isn't older than time
+quint64 Plot::lowerBound(quint64 first, quint64 last, float time) const
 {
-    glLineWidth(3.0f);
-    glColor3f(color.redF(), color.greenF(), color.blueF());
-    glVertexPointer(2, GL_FLOAT, 0, m_data.data());
-    glEnableClientState(GL_VERTEX_ARRAY);
-    glDrawArrays(GL_LINE_STRIP, m_pos / 2, (m_count - m_pos) / 2);
-    glDrawArrays(GL_LINE_STRIP, 0, m_pos / 2);
-    glLineWidth(1.0f);
+    while (first < last) {
+        const quint64 mid = first + (last - first) / 2;
+        if (sampleTime(mid) < time) {
+            first = mid + 1;
+        } else {
+            last = mid;
+        }
+    }
+    return first;
+}
+
+void Plot::vertices(float start, float end, int segments, QVector<float> &vertices) const
+{
+    const quint64 count = m_count / 2;
+    if (count == 0) {
+        return;
+    }
+    const quint64 first = m_samples - count;
+
+    // include one sample beyond each border to connect the line to the edges
+    quint64 visibleStart = lowerBound(first, m_samples, start);
+    if (visibleStart > first) {
+        visibleStart--;
+    }
+    quint64 visibleEnd = lowerBound(visibleStart, m_samples, end);
+    if (visibleEnd < m_samples) {
+        visibleEnd++;
+    }
+
+    // choose the finest level that results in at most one bucket per segment
+    int level = 0;
+    while (level < m_levels.size() && ((visibleEnd - visibleStart) >> (LEVEL_SHIFT * level)) > quint64(segments)) {
+        level++;
+    }
+
+    if (level == 0) {
+        vertices.reserve(vertices.size() + (visibleEnd - visibleStart) * 2);
+        for (quint64 sample = visibleStart; sample < visibleEnd; sample++) {
+            const int pos = (sample % m_capacity) * 2;
+            vertices.append(m_data[pos]);
+            vertices.append(m_data[pos + 1]);
+        }
+        return;
+    }
+
+    const int shift = LEVEL_SHIFT * level;
+    const QVector<Bucket> &buckets = m_levels[level - 1];
+    // buckets that are partially outside of the ringbuffer still hold valid extrema
+    const quint64 firstBucket = visibleStart >> shift;
+    const quint64 lastBucket = (visibleEnd - 1) >> shift;
+    vertices.reserve(vertices.size() + (lastBucket - firstBucket + 1) * 4);
+    for (quint64 index = firstBucket; index <= lastBucket; index++) {
+        const Bucket &bucket = buckets[index % buckets.size()];
+        // keep the extrema in temporal order
+        if (bucket.tMin <= bucket.tMax) {
+            vertices << bucket.tMin << bucket.vMin << bucket.tMax << bucket.vMax;
+        } else {
+            vertices << bucket.tMax << bucket.vMax << bucket.tMin << bucket.vMin;
+        }
+    }
 }
 
 void Plot::mergeFrom(const Plot *p)
@@ -75,4 +160,5 @@ void Plot::clearData()
 {
     m_pos = 0;
     m_count = 0;
+    m_samples = 0;
 }
@@ -34,13 +34,26 @@ public:
 
 public:
     void addPoint(float time, float value);
-    void plot(const QColor &color) const;
+    void vertices(float start, float end, int segments, QVector<float> &vertices) const;
     void mergeFrom(const Plot *p);
     void clearData();
 
     const QString& name() const { return m_name; }
     float time() const { return m_time; }
 
+private:
+    // minimum and maximum of consecutive samples
+    struct Bucket
+    {
+        float tMin;
+        float vMin;
+        float tMax;
+        float vMax;
+    };
+
+    quint64 lowerBound(quint64 first, quint64 last, float time) const;
+    float sampleTime(quint64 sample) const { return m_data[(sample % m_capacity) * 2]; }
+
 private:
     QString m_name;
     // used as ringbuffer
@@ -48,6 +61,12 @@ private:
     int m_pos;
     int m_count;
     float m_time;
+    const int m_capacity;
+    // total number of samples added since the last clear
+    quint64 m_samples;
+    // min/max pyramid, each level merges 4 buckets of the level below
+    // level 0 is m_data itself, the buckets are ringbuffers as well
+    QVector<QVector<Bucket>> m_levels;
 };
 
 Q_DECLARE_METATYPE(Plot*)
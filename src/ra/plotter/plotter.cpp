@@ -30,7 +30,7 @@
 #include <QMenu>
 #include <QSettings>
 #include <QStringBuilder>
-#include <unordered_map>
+#include <QVarLengthArray>
 
 Plotter::Plotter() :
     QWidget(nullptr, Qt::Window),
@@ -109,8 +109,12 @@ Plotter::Plotter() :
 Plotter::~Plotter()
 {
     delete ui;
-    qDeleteAll(m_plots);
-    qDeleteAll(m_frozenPlots);
+    for (const Channel &channel : m_channels) {
+        delete channel.plot;
+        delete channel.frozenPlot;
+    }
+    qDeleteAll(m_layouts);
+    qDeleteAll(m_groups);
 }
 
 void Plotter::closeEvent(QCloseEvent *event)
@@ -203,20 +207,19 @@ void Plotter::setFreeze(bool freeze)
 {
     if (!freeze && m_freeze) {
         // merge plots on unfreezing
-        foreach (QStandardItem *item, m_items) {
-            Plot *freezePlot = m_frozenPlots.value(item, nullptr);
+        for (Channel &channel : m_channels) {
+            Plot *freezePlot = channel.frozenPlot;
             if (freezePlot == nullptr) {
                 continue;
             }
             // remove freeze plot entry
-            m_frozenPlots.remove(item);
+            channel.frozenPlot = nullptr;
 
-            Plot *plot = m_plots.value(item, nullptr);
-            if (plot != nullptr) { // merge freeze plot if there's already a plot
-                plot->mergeFrom(freezePlot);
+            if (channel.plot != nullptr) { // merge freeze plot if there's already a plot
+                channel.plot->mergeFrom(freezePlot);
                 delete freezePlot;
             } else { // otherwise reuse it as plot
-                m_plots[item] = freezePlot;
+                channel.plot = freezePlot;
             }
         }
     }
@@ -247,70 +250,69 @@ void Plotter::handleStatus(const Status &status)
         float time = (worldState.time() - m_startTime) / 1E9;
 
         if (worldState.has_ball()) {
-            parseMessage(worldState.ball(), QStringLiteral("Ball"), time);
+            parseMessage(worldState.ball(), channelGroup(BallGroup), time);
 
+            ChannelGroup *rawGroup = channelGroup(BallRawGroup);
             for (int i = 0; i < worldState.ball().raw_size(); i++) {
                 const world::BallPosition &p = worldState.ball().raw(i);
-                parseMessage(p, QStringLiteral("Ball.raw"), (p.time() - m_startTime) / 1E9);
+                parseMessage(p, rawGroup, (p.time() - m_startTime) / 1E9);
             }
         }
 
         for (int i = 0; i < worldState.yellow_size(); i++) {
             const world::Robot &robot = worldState.yellow(i);
-            parseMessage(robot, QString(QStringLiteral("Yellow.%1")).arg(robot.id()), time);
+            parseMessage(robot, channelGroup(YellowGroup, robot.id()), time);
 
-            const QString rawParent = QString(QStringLiteral("Yellow.%1.raw")).arg(robot.id());
+            ChannelGroup *rawGroup = channelGroup(YellowRawGroup, robot.id());
             for (int i = 0; i < robot.raw_size(); i++) {
                 const world::RobotPosition &p = robot.raw(i);
-                parseMessage(p, rawParent, (p.time() - m_startTime) / 1E9);
+                parseMessage(p, rawGroup, (p.time() - m_startTime) / 1E9);
             }
         }
 
         for (int i = 0; i < worldState.blue_size(); i++) {
             const world::Robot &robot = worldState.blue(i);
-            parseMessage(robot, QString(QStringLiteral("Blue.%1")).arg(robot.id()), time);
+            parseMessage(robot, channelGroup(BlueGroup, robot.id()), time);
 
-            const QString rawParent = QString(QStringLiteral("Blue.%1.raw")).arg(robot.id());
+            ChannelGroup *rawGroup = channelGroup(BlueRawGroup, robot.id());
             for (int i = 0; i < robot.raw_size(); i++) {
                 const world::RobotPosition &p = robot.raw(i);
-                parseMessage(p, rawParent, (p.time() - m_startTime) / 1E9);
+                parseMessage(p, rawGroup, (p.time() - m_startTime) / 1E9);
             }
         }
 
         for (int i = 0; i < worldState.radio_response_size(); i++) {
             const robot::RadioResponse &response = worldState.radio_response(i);
-            const QString name = QString(QStringLiteral("%1-%2")).arg(response.generation()).arg(response.id());
             const float responseTime = (response.time() - m_startTime) / 1E9;
-            parseMessage(response, QString(QStringLiteral("RadioResponse.%1")).arg(name), responseTime);
-            parseMessage(response.estimated_speed(), QString(QStringLiteral("RadioResponse.%1.estimatedSpeed")).arg(name), responseTime);
+            parseMessage(response, channelGroup(RadioResponseGroup, response.generation(), response.id()), responseTime);
+            parseMessage(response.estimated_speed(),
+                         channelGroup(RadioResponseSpeedGroup, response.generation(), response.id()), responseTime);
         }
     }
 
     for (int i = 0; i < status->radio_command_size(); i++) {
         const robot::RadioCommand &command = status->radio_command(i);
-        const QString name = QString(QStringLiteral("%1-%2")).arg(command.generation()).arg(command.id());
 
         const robot::Command &cmd = command.command();
-        parseMessage(cmd, QString(QStringLiteral("RadioCommand.%1")).arg(name), time);
-        parseMessage(cmd.debug(), QString(QStringLiteral("RadioCommand.%1.debug")).arg(name), time);
+        parseMessage(cmd, channelGroup(RadioCommandGroup, command.generation(), command.id()), time);
+        parseMessage(cmd.debug(), channelGroup(RadioCommandDebugGroup, command.generation(), command.id()), time);
     }
 
     if (status->has_timing()) {
         const amun::Timing &timing = status->timing();
-        parseMessage(timing, QStringLiteral("Timing"), time);
+        parseMessage(timing, channelGroup(TimingGroup), time);
     }
 
     if (status->has_debug()) {
         const amun::DebugValues &debug = status->debug();
         // ignore controller as it can create plots via RadioCommand.%1.debug
         if (debug.source() != amun::Controller) {
-            QVector<QStandardItem *> emptyLookup;
-            const QString parent = (debug.source() == amun::StrategyBlue) ?
-                        QStringLiteral("BlueStrategy") : QStringLiteral("YellowStrategy");
+            ChannelGroup *group = channelGroup((debug.source() == amun::StrategyBlue) ?
+                                               BlueStrategyGroup : YellowStrategyGroup);
             // strategies can add plots with arbitrary names
             for (int i = 0; i < debug.plot_size(); ++i) {
                 const amun::PlotValue &value = debug.plot(i);
-                addPoint(value.name(), parent, time, value.value(), emptyLookup, 0);
+                addNamedPoint(group, value.name(), time, value.value());
             }
         }
     }
@@ -353,150 +355,353 @@ void Plotter::invalidatePlots()
 
     const float time = (m_time - m_startTime) / 1E9;
 
-    foreach (QStandardItem *item, m_items) {
-        // check the role that is currently updated
-        QHash<QStandardItem*, Plot*> &plots = (m_freeze) ? m_frozenPlots : m_plots;
-        Plot *plot = plots.value(item, nullptr);
+    foreach (const Channel &channel, m_channels) {
+        // check the plot that is currently updated
+        const Plot *plot = (m_freeze) ? channel.frozenPlot : channel.plot;
         if (plot == nullptr) {
             continue;
         }
         if (plot->time() + 5 < time) {
             // mark old plots
-            item->setForeground(Qt::gray);
+            channel.item->setForeground(Qt::gray);
         }
     }
 }
 
-enum class SpecialFieldNames: int {
-    none = 0,
-    v_f = 1,
-    v_s = 2,
-    v_x = 3,
-    v_y = 4,
-    v_d_x = 5,
-    v_d_y = 6,
-    v_ctrl_out_f = 7,
-    v_ctrl_out_s = 8,
-    max = 9
+// typed accessors for the messages that arrive with every status,
+// these avoid the virtual calls and checks of the protobuf reflection
+#define PLOT_FLOAT(Type, name) \
+    { #name, [](const google::protobuf::Message &message, const google::protobuf::FieldDescriptor *, float &value) { \
+        const Type &m = static_cast<const Type &>(message); \
+        value = m.name(); \
+        return m.has_##name(); \
+    } }
+#define PLOT_BOOL(Type, name) \
+    { #name, [](const google::protobuf::Message &message, const google::protobuf::FieldDescriptor *, float &value) { \
+        const Type &m = static_cast<const Type &>(message); \
+        value = m.name() ? 1 : 0; \
+        return m.has_##name(); \
+    } }
+
+struct TypedField
+{
+    const char *name;
+    bool (*getter)(const google::protobuf::Message &, const google::protobuf::FieldDescriptor *, float &);
+};
+
+static const TypedField ballFields[] = {
+    PLOT_FLOAT(world::Ball, p_x), PLOT_FLOAT(world::Ball, p_y), PLOT_FLOAT(world::Ball, p_z),
+    PLOT_FLOAT(world::Ball, v_x), PLOT_FLOAT(world::Ball, v_y), PLOT_FLOAT(world::Ball, v_z)
 };
 
-static const std::unordered_map<std::string, SpecialFieldNames> fieldNameMap = {
-    std::make_pair("v_f", SpecialFieldNames::v_f),
-    std::make_pair("v_s", SpecialFieldNames::v_s),
-    std::make_pair("v_x", SpecialFieldNames::v_x),
-    std::make_pair("v_y", SpecialFieldNames::v_y),
-    std::make_pair("v_desired_x", SpecialFieldNames::v_d_x),
-    std::make_pair("v_desired_y", SpecialFieldNames::v_d_y),
-    std::make_pair("v_ctrl_out_f", SpecialFieldNames::v_ctrl_out_f),
-    std::make_pair("v_ctrl_out_s", SpecialFieldNames::v_ctrl_out_s),
+static const TypedField ballPositionFields[] = {
+    PLOT_FLOAT(world::BallPosition, p_x), PLOT_FLOAT(world::BallPosition, p_y),
+    PLOT_FLOAT(world::BallPosition, derived_z), PLOT_FLOAT(world::BallPosition, v_x),
+    PLOT_FLOAT(world::BallPosition, v_y), PLOT_FLOAT(world::BallPosition, system_delay),
+    PLOT_FLOAT(world::BallPosition, time_diff_scaled)
 };
 
-void Plotter::parseMessage(const google::protobuf::Message &message, const QString &parent, float time)
+static const TypedField robotFields[] = {
+    PLOT_FLOAT(world::Robot, p_x), PLOT_FLOAT(world::Robot, p_y), PLOT_FLOAT(world::Robot, phi),
+    PLOT_FLOAT(world::Robot, v_x), PLOT_FLOAT(world::Robot, v_y), PLOT_FLOAT(world::Robot, omega)
+};
+
+static const TypedField robotPositionFields[] = {
+    PLOT_FLOAT(world::RobotPosition, p_x), PLOT_FLOAT(world::RobotPosition, p_y),
+    PLOT_FLOAT(world::RobotPosition, phi), PLOT_FLOAT(world::RobotPosition, v_x),
+    PLOT_FLOAT(world::RobotPosition, v_y), PLOT_FLOAT(world::RobotPosition, system_delay),
+    PLOT_FLOAT(world::RobotPosition, time_diff_scaled), PLOT_FLOAT(world::RobotPosition, omega)
+};
+
+static const TypedField commandFields[] = {
+    PLOT_FLOAT(robot::Command, v_f), PLOT_FLOAT(robot::Command, v_s), PLOT_FLOAT(robot::Command, omega),
+    PLOT_FLOAT(robot::Command, kick_power), PLOT_FLOAT(robot::Command, dribbler),
+    PLOT_FLOAT(robot::Command, v_x), PLOT_FLOAT(robot::Command, v_y),
+    PLOT_BOOL(robot::Command, direct), PLOT_BOOL(robot::Command, standby),
+    PLOT_BOOL(robot::Command, strategy_controlled), PLOT_BOOL(robot::Command, force_kick),
+    PLOT_BOOL(robot::Command, network_controlled), PLOT_BOOL(robot::Command, eject_sdcard)
+};
+
+static const TypedField controllerDebugFields[] = {
+    PLOT_FLOAT(robot::ControllerDebug, p_desired_x), PLOT_FLOAT(robot::ControllerDebug, p_desired_y),
+    PLOT_FLOAT(robot::ControllerDebug, v_desired_x), PLOT_FLOAT(robot::ControllerDebug, v_desired_y),
+    PLOT_FLOAT(robot::ControllerDebug, v_ctrl_out_s), PLOT_FLOAT(robot::ControllerDebug, v_ctrl_out_f),
+    PLOT_FLOAT(robot::ControllerDebug, v_ctrl_out_omega), PLOT_FLOAT(robot::ControllerDebug, traj_age),
+    PLOT_FLOAT(robot::ControllerDebug, a_desired_x), PLOT_FLOAT(robot::ControllerDebug, a_desired_y)
+};
+
+static const TypedField radioResponseFields[] = {
+    PLOT_FLOAT(robot::RadioResponse, battery), PLOT_FLOAT(robot::RadioResponse, packet_loss_rx),
+    PLOT_FLOAT(robot::RadioResponse, packet_loss_tx), PLOT_FLOAT(robot::RadioResponse, radio_rtt),
+    PLOT_BOOL(robot::RadioResponse, ball_detected), PLOT_BOOL(robot::RadioResponse, cap_charged),
+    PLOT_BOOL(robot::RadioResponse, error_present)
+};
+
+static const TypedField speedStatusFields[] = {
+    PLOT_FLOAT(robot::SpeedStatus, v_f), PLOT_FLOAT(robot::SpeedStatus, v_s), PLOT_FLOAT(robot::SpeedStatus, omega)
+};
+
+#undef PLOT_FLOAT
+#undef PLOT_BOOL
+
+template<int N>
+static const TypedField *findTypedField(const TypedField (&fields)[N], const std::string &name)
+{
+    for (const TypedField &field : fields) {
+        if (name == field.name) {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+static const TypedField *typedField(const google::protobuf::Descriptor *desc, const std::string &name)
+{
+    if (desc == world::Ball::descriptor()) {
+        return findTypedField(ballFields, name);
+    } else if (desc == world::BallPosition::descriptor()) {
+        return findTypedField(ballPositionFields, name);
+    } else if (desc == world::Robot::descriptor()) {
+        return findTypedField(robotFields, name);
+    } else if (desc == world::RobotPosition::descriptor()) {
+        return findTypedField(robotPositionFields, name);
+    } else if (desc == robot::Command::descriptor()) {
+        return findTypedField(commandFields, name);
+    } else if (desc == robot::ControllerDebug::descriptor()) {
+        return findTypedField(controllerDebugFields, name);
+    } else if (desc == robot::RadioResponse::descriptor()) {
+        return findTypedField(radioResponseFields, name);
+    } else if (desc == robot::SpeedStatus::descriptor()) {
+        return findTypedField(speedStatusFields, name);
+    }
+    return nullptr;
+}
+
+static bool reflectFloat(const google::protobuf::Message &message, const google::protobuf::FieldDescriptor *field, float &value)
 {
-    const google::protobuf::Descriptor *desc = message.GetDescriptor();
     const google::protobuf::Reflection *refl = message.GetReflection();
+    if (!refl->HasField(message, field)) {
+        return false;
+    }
+    value = refl->GetFloat(message, field);
+    return true;
+}
 
-    float specialFields[static_cast<int>(SpecialFieldNames::max)];
-    for (int i = 0; i < static_cast<int>(SpecialFieldNames::max); ++i) {
-        specialFields[i] = NAN;
+static bool reflectBool(const google::protobuf::Message &message, const google::protobuf::FieldDescriptor *field, float &value)
+{
+    const google::protobuf::Reflection *refl = message.GetReflection();
+    if (!refl->HasField(message, field)) {
+        return false;
     }
+    value = refl->GetBool(message, field) ? 1 : 0;
+    return true;
+}
 
-    const int extraFields = 4;
-    if (!m_itemLookup.contains(parent)) {
-        m_itemLookup[parent] = QVector<QStandardItem *>(desc->field_count() + extraFields, nullptr);
+const Plotter::MessageLayout *Plotter::messageLayout(const google::protobuf::Descriptor *desc)
+{
+    MessageLayout *layout = m_layouts.value(desc, nullptr);
+    if (layout != nullptr) {
+        return layout;
     }
-    // just a performance optimization
-    QVector<QStandardItem *> &childLookup = m_itemLookup[parent];
 
+    layout = new MessageLayout;
+    QHash<QString, int> indices;
     for (int i = 0; i < desc->field_count(); i++) {
         const google::protobuf::FieldDescriptor *field = desc->field(i);
+        if (field->is_repeated()) {
+            continue;
+        }
 
-        // check type and that the field exists
-        if (field->cpp_type() == google::protobuf::FieldDescriptor::CPPTYPE_FLOAT
-                && refl->HasField(message, field)) {
-            const std::string &name = field->name();
-            const float value = refl->GetFloat(message, field);
-            if (fieldNameMap.count(name) > 0) {
-                SpecialFieldNames fn = fieldNameMap.at(name);
-                specialFields[static_cast<int>(fn)] = value;
-            }
-            addPoint(name, parent, time, value, childLookup, i);
-        } else if (field->cpp_type() == google::protobuf::FieldDescriptor::CPPTYPE_BOOL
-                   && refl->HasField(message, field)) {
-            const std::string &name = field->name();
-            const float value = refl->GetBool(message,field) ? 1 : 0;
-            addPoint(name, parent, time, value, childLookup, i);
+        FieldGetter getter;
+        if (field->cpp_type() == google::protobuf::FieldDescriptor::CPPTYPE_FLOAT) {
+            getter = &reflectFloat;
+        } else if (field->cpp_type() == google::protobuf::FieldDescriptor::CPPTYPE_BOOL) {
+            getter = &reflectBool;
+        } else {
+            continue;
+        }
+        // prefer the typed accessor if there is one
+        const TypedField *typed = typedField(desc, field->name());
+        if (typed != nullptr) {
+            getter = typed->getter;
         }
-    }
 
-    // precompute strings
-    static const std::string staticVLocal("v_local");
-    static const std::string staticVDesired("v_desired");
-    static const std::string staticVCtrlOut("v_ctrl_out");
-    static const std::string staticVGlobal("v_global");
+        const QString name = QString::fromStdString(field->name());
+        indices[name] = layout->fields.size();
+        layout->fields.append({ getter, field, name });
+    }
 
     // add length of speed vectors
-    tryAddLength(staticVLocal, parent, time,
-                 specialFields[static_cast<int>(SpecialFieldNames::v_f)],
-                 specialFields[static_cast<int>(SpecialFieldNames::v_s)],
-                 childLookup, desc->field_count()+0);
-    tryAddLength(staticVDesired, parent, time,
-                 specialFields[static_cast<int>(SpecialFieldNames::v_d_x)],
-                 specialFields[static_cast<int>(SpecialFieldNames::v_d_y)],
-                 childLookup, desc->field_count()+1);
-    tryAddLength(staticVCtrlOut, parent, time,
-                 specialFields[static_cast<int>(SpecialFieldNames::v_ctrl_out_f)],
-                 specialFields[static_cast<int>(SpecialFieldNames::v_ctrl_out_f)],
-                 childLookup, desc->field_count()+2);
-    tryAddLength(staticVGlobal, parent, time,
-                 specialFields[static_cast<int>(SpecialFieldNames::v_x)],
-                 specialFields[static_cast<int>(SpecialFieldNames::v_y)],
-                 childLookup, desc->field_count()+3);
+    static const struct {
+        const char *name;
+        const char *first;
+        const char *second;
+    } lengths[] = {
+        { "v_local", "v_f", "v_s" },
+        { "v_desired", "v_desired_x", "v_desired_y" },
+        { "v_ctrl_out", "v_ctrl_out_f", "v_ctrl_out_s" },
+        { "v_global", "v_x", "v_y" }
+    };
+    for (const auto &length : lengths) {
+        const QString first(length.first);
+        const QString second(length.second);
+        if (indices.contains(first) && indices.contains(second)) {
+            layout->lengths.append({ indices[first], indices[second], QString(length.name) });
+        }
+    }
+
+    m_layouts[desc] = layout;
+    return layout;
 }
 
-void Plotter::tryAddLength(const std::string &name, const QString &parent, float time, float value1, float value2,
-                           QVector<QStandardItem *> &childLookup, int descriptorIndex)
+Plotter::ChannelGroup *Plotter::channelGroup(GroupType type, quint32 a, quint32 b)
 {
-    // if both values are set
-    if (!std::isnan(value1) && !std::isnan(value2)) {
-        const float value = std::sqrt(value1 * value1 + value2 * value2);
-        addPoint(name, parent, time, value, childLookup, descriptorIndex);
+    const quint64 key = (quint64(type) << 56) | (quint64(a & 0xFFFFFFF) << 28) | quint64(b & 0xFFFFFFF);
+    ChannelGroup *group = m_groups.value(key, nullptr);
+    if (group != nullptr) {
+        return group;
+    }
+
+    group = new ChannelGroup;
+    switch (type) {
+    case BallGroup:
+        group->prefix = QStringLiteral("Ball");
+        break;
+    case BallRawGroup:
+        group->prefix = QStringLiteral("Ball.raw");
+        break;
+    case YellowGroup:
+        group->prefix = QString(QStringLiteral("Yellow.%1")).arg(a);
+        break;
+    case YellowRawGroup:
+        group->prefix = QString(QStringLiteral("Yellow.%1.raw")).arg(a);
+        break;
+    case BlueGroup:
+        group->prefix = QString(QStringLiteral("Blue.%1")).arg(a);
+        break;
+    case BlueRawGroup:
+        group->prefix = QString(QStringLiteral("Blue.%1.raw")).arg(a);
+        break;
+    case RadioResponseGroup:
+        group->prefix = QString(QStringLiteral("RadioResponse.%1-%2")).arg(a).arg(b);
+        break;
+    case RadioResponseSpeedGroup:
+        group->prefix = QString(QStringLiteral("RadioResponse.%1-%2.estimatedSpeed")).arg(a).arg(b);
+        break;
+    case RadioCommandGroup:
+        group->prefix = QString(QStringLiteral("RadioCommand.%1-%2")).arg(a).arg(b);
+        break;
+    case RadioCommandDebugGroup:
+        group->prefix = QString(QStringLiteral("RadioCommand.%1-%2.debug")).arg(a).arg(b);
+        break;
+    case TimingGroup:
+        group->prefix = QStringLiteral("Timing");
+        break;
+    case BlueStrategyGroup:
+        group->prefix = QStringLiteral("BlueStrategy");
+        break;
+    case YellowStrategyGroup:
+        group->prefix = QStringLiteral("YellowStrategy");
+        break;
     }
+    m_groups[key] = group;
+    return group;
 }
 
-void Plotter::addPoint(const std::string &name, const QString &parent, float time, float value,
-                       QVector<QStandardItem *> &childLookup, int descriptorIndex)
+void Plotter::parseMessage(const google::protobuf::Message &message, ChannelGroup *group, float time)
 {
-    QStandardItem *item;
-    if (childLookup.isEmpty() || childLookup[descriptorIndex] == nullptr) {
-        // full name for item retrieval
-        const QString fullName = parent % QStringLiteral(".") % QString::fromStdString(name);
-        item = getItem(fullName);
-        if (!childLookup.isEmpty()) {
-            childLookup[descriptorIndex] = item;
+    const MessageLayout *layout = messageLayout(message.GetDescriptor());
+    const int fieldCount = layout->fields.size();
+    if (group->channels.isEmpty()) {
+        group->channels.fill(-1, fieldCount + layout->lengths.size());
+    }
+
+    QVarLengthArray<float, 32> values(fieldCount);
+    for (int i = 0; i < fieldCount; i++) {
+        const MessageLayout::Field &field = layout->fields[i];
+        float value;
+        if (!field.getter(message, field.field, value)) {
+            values[i] = NAN;
+            continue;
+        }
+        values[i] = value;
+
+        int &channelId = group->channels[i];
+        if (channelId == -1) {
+            channelId = createChannel(group->prefix % QStringLiteral(".") % field.name);
+        }
+        addPoint(channelId, time, value);
+    }
+
+    for (int i = 0; i < layout->lengths.size(); i++) {
+        const MessageLayout::Length &length = layout->lengths[i];
+        const float value1 = values[length.first];
+        const float value2 = values[length.second];
+        // if both values are set
+        if (std::isnan(value1) || std::isnan(value2)) {
+            continue;
         }
+
+        int &channelId = group->channels[fieldCount + i];
+        if (channelId == -1) {
+            channelId = createChannel(group->prefix % QStringLiteral(".") % length.name);
+        }
+        addPoint(channelId, time, std::sqrt(value1 * value1 + value2 * value2));
+    }
+}
+
+void Plotter::addNamedPoint(ChannelGroup *group, const std::string &name, float time, float value)
+{
+    // avoid copying the name for known plots
+    const QByteArray key = QByteArray::fromRawData(name.data(), int(name.size()));
+    auto it = group->namedChannels.constFind(key);
+    int channelId;
+    if (it == group->namedChannels.constEnd()) {
+        channelId = createChannel(group->prefix % QStringLiteral(".") % QString::fromStdString(name));
+        group->namedChannels.insert(QByteArray(name.data(), int(name.size())), channelId);
     } else {
-        item = childLookup[descriptorIndex];
+        channelId = it.value();
+    }
+    addPoint(channelId, time, value);
+}
+
+int Plotter::createChannel(const QString &fullName)
+{
+    QStandardItem *item = getItem(fullName);
+    // reuse the channel if another group already created the item
+    const QVariant existing = item->data(Plotter::ChannelRole);
+    if (existing.isValid()) {
+        return existing.toInt();
     }
 
+    const int channelId = m_channels.size();
+    m_channels.append({ item, nullptr, nullptr });
+    item->setData(channelId, Plotter::ChannelRole);
+    return channelId;
+}
+
+void Plotter::addPoint(int channelId, float time, float value)
+{
+    Channel &channel = m_channels[channelId];
+    QStandardItem *item = channel.item;
+
     // save data into a hidden plot while freezed
-    QHash<QStandardItem*, Plot*> &plots = (m_freeze) ? m_frozenPlots : m_plots;
-    Plot *plot = plots.value(item, nullptr);
+    Plot *&plot = (m_freeze) ? channel.frozenPlot : channel.plot;
 
     if (plot == nullptr) { // create new plot
-        const QString fullName = parent % QStringLiteral(".") % QString::fromStdString(name);
-        plot = new Plot(fullName, this);
+        const QString fullName = item->data(Plotter::FullNameRole).toString();
+        Plot *newPlot = new Plot(fullName, this);
         item->setCheckable(true);
         if (m_selection.contains(fullName)) {
-            addPlot(plot); // manually add plot as itemChanged won't add it
+            addPlot(newPlot); // manually add plot as itemChanged won't add it
             item->setCheckState(Qt::Checked);
         } else {
             item->setCheckState(Qt::Unchecked);
         }
         // set plot information after the check state
-        // itemChanged only checks items in m_plots
+        // itemChanged only checks channels with a plot
         // thus no enable / disable flickering will occur
-        plots[item] = plot;
+        plot = newPlot;
     }
     // only clear foreground if it's set, causes a serious performance regression
     // if it's always done
@@ -512,14 +717,12 @@ void Plotter::clearData()
     m_startTime = 0;
     m_guiTimer->requestTriggering();
     // delete everything
-    foreach (QStandardItem *item, m_items) {
+    for (Channel &channel : m_channels) {
         // just drop the freeze plot
-        if (m_frozenPlots.contains(item)) {
-            delete m_frozenPlots[item];
-            m_frozenPlots.remove(item);
-        }
-        if (m_plots.contains(item)) {
-            m_plots[item]->clearData();
+        delete channel.frozenPlot;
+        channel.frozenPlot = nullptr;
+        if (channel.plot != nullptr) {
+            channel.plot->clearData();
         }
     }
     // force unfreeze as no more data is available
@@ -528,9 +731,13 @@ void Plotter::clearData()
 
 void Plotter::itemChanged(QStandardItem *item)
 {
-    // always use m_plots as that's what governs which plot to display
-    if (m_plots.contains(item)) {
-        Plot *plot = m_plots[item];
+    const QVariant channelId = item->data(Plotter::ChannelRole);
+    if (!channelId.isValid()) {
+        return;
+    }
+    // always use the normal plot as that's what governs which plot to display
+    Plot *plot = m_channels[channelId.toInt()].plot;
+    if (plot != nullptr) {
         const QString name = item->data(Plotter::FullNameRole).toString();
         if (item->checkState() == Qt::Checked) {
             // only add plot if it isn't in our selection yet
@@ -68,16 +68,78 @@ private slots:
 private:
     bool eventFilter(QObject *obj, QEvent *event) override;
 
+    // returns false if the field isn't set
+    typedef bool (*FieldGetter)(const google::protobuf::Message &message,
+                                const google::protobuf::FieldDescriptor *field, float &value);
+
+    // plottable fields of a message type, resolved once per type
+    struct MessageLayout
+    {
+        struct Field
+        {
+            FieldGetter getter;
+            const google::protobuf::FieldDescriptor *field;
+            QString name;
+        };
+        // length of a vector given by two fields
+        struct Length
+        {
+            int first;
+            int second;
+            QString name;
+        };
+        QVector<Field> fields;
+        QVector<Length> lengths;
+    };
+
+    struct Channel
+    {
+        QStandardItem *item;
+        Plot *plot;
+        // receives the values while the plotter is frozen
+        Plot *frozenPlot;
+    };
+
+    // channels of one message source, e.g. a robot
+    struct ChannelGroup
+    {
+        QString prefix;
+        // channel id for each field and length of the message layout, -1 if not created yet
+        QVector<int> channels;
+        // channels with arbitrary names, used by the strategies
+        QHash<QByteArray, int> namedChannels;
+    };
+
+    enum GroupType {
+        BallGroup,
+        BallRawGroup,
+        YellowGroup,
+        YellowRawGroup,
+        BlueGroup,
+        BlueRawGroup,
+        RadioResponseGroup,
+        RadioResponseSpeedGroup,
+        RadioCommandGroup,
+        RadioCommandDebugGroup,
+        TimingGroup,
+        BlueStrategyGroup,
+        YellowStrategyGroup
+    };
+
     void loadSelection();
     QStandardItem* getItem(const QString &name);
     void addRootItem(const QString &name, const QString &displayName);
-    void parseMessage(const google::protobuf::Message &message, const QString &parent, float time);
-    void addPoint(const std::string &name, const QString &parent, float time, float value, QVector<QStandardItem *> &childLookup, int descriptorIndex);
-    void tryAddLength(const std::string &name, const QString &parent, float time, float value1, float value2, QVector<QStandardItem *> &childLookup, int descriptorIndex);
+    const MessageLayout *messageLayout(const google::protobuf::Descriptor *descriptor);
+    ChannelGroup *channelGroup(GroupType type, quint32 a = 0, quint32 b = 0);
+    void parseMessage(const google::protobuf::Message &message, ChannelGroup *group, float time);
+    void addNamedPoint(ChannelGroup *group, const std::string &name, float time, float value);
+    int createChannel(const QString &fullName);
+    void addPoint(int channelId, float time, float value);
 
 private:
     enum ItemRole {
-        FullNameRole = Qt::UserRole + 2
+        FullNameRole = Qt::UserRole + 2,
+        ChannelRole = Qt::UserRole + 3
     };
 
     Ui::Plotter *ui;
@@ -87,9 +149,10 @@ private:
     bool m_freeze;
     GuiTimer *m_guiTimer;
     QHash<QString, QStandardItem*> m_items;
-    QHash<QString, QVector<QStandardItem *>> m_itemLookup;
-    QHash<QStandardItem*, Plot*> m_plots;
-    QHash<QStandardItem*, Plot*> m_frozenPlots;
+    QHash<const google::protobuf::Descriptor *, MessageLayout *> m_layouts;
+    QHash<quint64, ChannelGroup *> m_groups;
+    // flat registry, indexed by channel id
+    QVector<Channel> m_channels;
     QSet<QString> m_selection;
     QStandardItemModel m_model;
     LeafFilterProxyModel *m_proxy;
@@ -48,6 +48,7 @@ const QList<QColor> PlotterWidget::m_colors = QList<QColor>()
 PlotterWidget::PlotterWidget(QWidget *parent) :
     QGLWidget(parent),
     m_font(QGuiApplication::font()),
+    m_vertexBuffer(QOpenGLBuffer::VertexBuffer),
     m_time(0.0),
     m_yMin(-5.0),
     m_yMax(5.0),
@@ -69,6 +70,11 @@ PlotterWidget::PlotterWidget(QWidget *parent) :
 
 PlotterWidget::~PlotterWidget()
 {
+    // the buffer and the atlas texture belong to our context
+    makeCurrent();
+    if (m_vertexBuffer.isCreated()) {
+        m_vertexBuffer.destroy();
+    }
     delete m_textureCache;
 }
 
@@ -88,6 +94,10 @@ void PlotterWidget::paintGL()
     glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
+    QFontMetrics fm(m_font);
+    m_textureCache->beginFrame((fm.height() + 4) * dpr);
+    m_textQuads.resize(0);
+
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
 
@@ -102,7 +112,8 @@ void PlotterWidget::paintGL()
     // draw plots and add the corresponding label
     int numPlots = 0;
     foreach (const Plot *plot, m_plots) {
-        plot->plot(m_colorMap[plot]);
+        // about one line segment per pixel, independent of the number of samples
+        drawPlot(plot, m_colorMap[plot], width() * dpr);
         numPlots++;
         renderText(10, 20 * numPlots, plot->name(), m_colorMap[plot]);
     }
@@ -116,6 +127,34 @@ void PlotterWidget::paintGL()
                                                    QString::number(m_mousePos.y(), 'f', 4));
         drawLabel(width(), height(), true, posString);
     }
+
+    flushText();
+}
+
+void PlotterWidget::drawPlot(const Plot *plot, const QColor &color, int segments)
+{
+    m_vertices.resize(0); // keeps the allocated memory
+    plot->vertices(m_time - m_duration + m_offset, m_time + m_offset, segments, m_vertices);
+    if (m_vertices.size() < 4) {
+        return;
+    }
+
+    if (!m_vertexBuffer.isCreated()) {
+        m_vertexBuffer.create();
+        m_vertexBuffer.setUsagePattern(QOpenGLBuffer::StreamDraw);
+    }
+    m_vertexBuffer.bind();
+    // reallocating lets the driver orphan the previous contents
+    m_vertexBuffer.allocate(m_vertices.constData(), m_vertices.size() * sizeof(float));
+
+    glLineWidth(3.0f);
+    glColor3f(color.redF(), color.greenF(), color.blueF());
+    glVertexPointer(2, GL_FLOAT, 0, nullptr);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glDrawArrays(GL_LINE_STRIP, 0, m_vertices.size() / 2);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glLineWidth(1.0f);
+    m_vertexBuffer.release();
 }
 
 void PlotterWidget::drawCoordSys()
@@ -401,41 +440,86 @@ QPointF PlotterWidget::mapFromScene(double x, double y, double z)
     return QPointF(win_x, win_y);
 }
 
-// in widget coordinates!
+// in widget coordinates! the text is queued and drawn by flushText
 void PlotterWidget::renderText(int x, int y, const QString & str, const QColor color)
 {
-    GLuint textureId = 0;
-    QPixmap pixmap;
     QString cacheKey = str + color.name();
     QFontMetrics fm(m_font);
-    if (!m_textureCache->find(cacheKey, &textureId, &pixmap)) {
-        QRect textSize = fm.boundingRect(str);
-        qreal dpr = devicePixelRatio();
-        pixmap = QPixmap((textSize.width()+4)*dpr, (textSize.height()+4)*dpr);
-        pixmap.setDevicePixelRatio(dpr);
-        pixmap.fill(Qt::transparent);
+    qreal dpr = devicePixelRatio();
+    const TextureCache::Entry *entry = m_textureCache->find(cacheKey);
+    if (!entry) {
+        // fixed label height, allows packing the labels into rows of the atlas
+        QImage image((fm.width(str)+4)*dpr, (fm.height()+4)*dpr, QImage::Format_ARGB32_Premultiplied);
+        image.setDevicePixelRatio(dpr);
+        image.fill(Qt::transparent);
         {
-            QPainter painter(&pixmap);
+            QPainter painter(&image);
             painter.setFont(m_font);
             painter.setPen(color);
             painter.drawText(2, fm.ascent()+2, str);
         }
-        textureId = m_textureCache->insert(cacheKey, pixmap);
+        entry = m_textureCache->insert(cacheKey, image);
+        if (!entry) {
+            // atlas is full of labels for this frame, draw them to free the rows
+            flushText();
+            m_textureCache->beginFrame((fm.height() + 4) * dpr);
+            entry = m_textureCache->insert(cacheKey, image);
+            if (!entry) {
+                return;
+            }
+        }
+    }
+
+    const float left = x - 2;
+    const float top = y - 2 - fm.ascent();
+    const float right = left + entry->size.width() / dpr;
+    const float bottom = top + entry->size.height() / dpr;
+    const QRectF &tex = entry->texCoords;
+    const float quad[] = {
+        left, top, float(tex.left()), float(tex.top()),
+        right, top, float(tex.right()), float(tex.top()),
+        right, bottom, float(tex.right()), float(tex.bottom()),
+        left, bottom, float(tex.left()), float(tex.bottom())
+    };
+    for (float v : quad) {
+        m_textQuads.append(v);
+    }
+}
+
+void PlotterWidget::flushText()
+{
+    if (m_textQuads.isEmpty()) {
+        return;
     }
 
-    QPointF pos(x-2, y-2-fm.ascent());
     // map to widget coordinates
     glPushMatrix();
     glLoadIdentity();
     glOrtho(0, width(), height(), 0, -1, 1);
 
+    glEnable(GL_TEXTURE_2D);
+    m_textureCache->bind();
     glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    drawTexture(QRectF(pos, pixmap.size()/pixmap.devicePixelRatio()), textureId);
+    // the label images use premultiplied alpha
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 4 * sizeof(float), m_textQuads.constData());
+    glTexCoordPointer(2, GL_FLOAT, 4 * sizeof(float), m_textQuads.constData() + 2);
+    glDrawArrays(GL_QUADS, 0, m_textQuads.size() / 4);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+
     glDisable(GL_BLEND);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_TEXTURE_2D);
 
     // restore matrix
     glPopMatrix();
+
+    m_textQuads.resize(0);
 }
 
 void PlotterWidget::renderText(double x, double y, double z, const QString & str, const QColor color)
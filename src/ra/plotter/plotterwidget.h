@@ -24,6 +24,8 @@
 #include <QGLWidget>
 #include <QHash>
 #include <QMap>
+#include <QOpenGLBuffer>
+#include <QVector>
 
 class Plot;
 class TextureCache;
@@ -62,6 +64,7 @@ private slots:
 
 private:
     void drawCoordSys();
+    void drawPlot(const Plot *plot, const QColor &color, int segments);
     void drawHelpers();
     void drawLabel(int x, int y, bool rightAligned, const QString &str);
 
@@ -71,6 +74,7 @@ private:
     qreal devicePixelRatio() const;
     void renderText(int x, int y, const QString & str, const QColor color);
     void renderText(double x, double y, double z, const QString &str, const QColor color);
+    void flushText();
 
 private:
     QMap<QString, const Plot*> m_plots;
@@ -79,6 +83,11 @@ private:
     QFont m_font;
     TextureCache *m_textureCache;
     GuiTimer *m_guiTimer;
+    // streaming buffer for the decimated plot vertices
+    QOpenGLBuffer m_vertexBuffer;
+    QVector<float> m_vertices;
+    // labels of the current frame, drawn from the texture atlas in one pass
+    QVector<float> m_textQuads;
 
     double m_time;
     double m_yMin;
@@ -1,72 +1,152 @@
 #include "texturecache.h"
-#include "core/timer.h"
 
 TextureCache::TextureCache(QGLContext *context) :
     m_context(context),
-    m_cacheSize(0),
-    m_sizeLimit(10*1000*100)
+    m_texture(0),
+    m_size(1024),
+    m_rowHeight(0),
+    m_frame(0),
+    m_head(nullptr),
+    m_tail(nullptr)
 { }
 
 TextureCache::~TextureCache()
 {
-    for (TextureEntry *entry: m_entries) {
-        m_context->deleteTexture(entry->textureId);
+    if (m_texture != 0) {
+        glDeleteTextures(1, &m_texture);
     }
     qDeleteAll(m_entries);
 }
 
-bool TextureCache::find(const QString &key, GLuint *textureId, QPixmap *pixmap)
+void TextureCache::beginFrame(int rowHeight)
 {
-    if (m_entries.contains(key)) {
-        TextureEntry *entry = m_entries[key];
-        *textureId = entry->textureId;
-        *pixmap = entry->pixmap;
-        // update last used
-        m_lastUsed.remove(entry->lastUsed, key);
-        entry->lastUsed = Timer::systemTime();
-        m_lastUsed.insertMulti(entry->lastUsed, key);
-        return true;
+    m_frame++;
+    // every label must fit into a row
+    if (rowHeight > m_rowHeight || m_texture == 0) {
+        reset(rowHeight);
     }
-    return false;
 }
 
-GLuint TextureCache::insert(const QString &key, const QPixmap &pixmap)
+void TextureCache::reset(int rowHeight)
 {
-    remove(key);
-
-    m_cacheSize += calcSize(pixmap);
-    while (m_cacheSize > m_sizeLimit && m_lastUsed.size() > 0) {
-        // warning: delKey musn't get passed to remove as reference as it will be deleted!!!
-        QString delKey = m_lastUsed.first();
-        remove(delKey);
+    if (m_texture == 0) {
+        glGenTextures(1, &m_texture);
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_size, m_size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
     }
 
-    TextureEntry *entry = new TextureEntry;
-    entry->pixmap = pixmap;
-    entry->textureId = m_context->bindTexture(entry->pixmap);
-    entry->lastUsed = Timer::systemTime();
-    m_entries[key] = entry;
-    m_lastUsed.insertMulti(entry->lastUsed, key);
+    qDeleteAll(m_entries);
+    m_entries.clear();
 
-    return entry->textureId;
+    m_rowHeight = rowHeight;
+    m_rows.clear();
+    m_rows.resize(m_size / m_rowHeight);
+    m_head = nullptr;
+    m_tail = nullptr;
+    for (int i = 0; i < m_rows.size(); i++) {
+        Row &row = m_rows[i];
+        row.y = i * m_rowHeight;
+        row.used = 0;
+        row.lastFrame = 0;
+        row.prev = m_tail;
+        row.next = nullptr;
+        if (m_tail) {
+            m_tail->next = &row;
+        } else {
+            m_head = &row;
+        }
+        m_tail = &row;
+    }
 }
 
-int TextureCache::calcSize(const QPixmap &pixmap)
+void TextureCache::unlink(Row *row)
 {
-    return pixmap.width() * pixmap.height() * (pixmap.depth() / 8);
+    if (row->prev) {
+        row->prev->next = row->next;
+    } else {
+        m_head = row->next;
+    }
+    if (row->next) {
+        row->next->prev = row->prev;
+    } else {
+        m_tail = row->prev;
+    }
 }
 
-void TextureCache::remove(const QString &key)
+void TextureCache::touch(Row *row)
 {
-    if (!m_entries.contains(key)) {
+    row->lastFrame = m_frame;
+    if (row == m_head) {
         return;
     }
+    unlink(row);
+    row->prev = nullptr;
+    row->next = m_head;
+    m_head->prev = row;
+    m_head = row;
+}
 
-    TextureEntry *entry = m_entries[key];
-    m_context->deleteTexture(entry->textureId);
-    m_cacheSize -= calcSize(entry->pixmap);
-    m_lastUsed.remove(entry->lastUsed, key);
-    m_entries.remove(key);
+void TextureCache::evict(Row *row)
+{
+    foreach (const QString &key, row->keys) {
+        delete m_entries.take(key);
+    }
+    row->keys.clear();
+    row->used = 0;
+}
 
-    delete entry;
+const TextureCache::Entry *TextureCache::find(const QString &key)
+{
+    AtlasEntry *entry = m_entries.value(key, nullptr);
+    if (entry) {
+        touch(entry->row);
+    }
+    return entry;
+}
+
+const TextureCache::Entry *TextureCache::insert(const QString &key, const QImage &image)
+{
+    if (m_rows.isEmpty() || image.height() > m_rowHeight) {
+        return nullptr;
+    }
+    const int width = qMin(image.width(), m_size);
+
+    // append to the most recently used row or replace the least recently used one
+    Row *row = m_head;
+    if (row->used + width > m_size) {
+        row = m_tail;
+        // the labels of the current frame are drawn later on and must stay valid
+        if (row->lastFrame == m_frame && row->used > 0) {
+            return nullptr;
+        }
+        evict(row);
+    }
+    touch(row);
+
+    AtlasEntry *entry = new AtlasEntry;
+    entry->row = row;
+    entry->size = QSize(width, image.height());
+    entry->texCoords = QRectF(row->used / float(m_size), row->y / float(m_size),
+                              width / float(m_size), image.height() / float(m_size));
+
+    const QImage rgba = image.convertToFormat(QImage::Format_RGBA8888_Premultiplied);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, rgba.bytesPerLine() / 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, row->used, row->y, width, rgba.height(),
+                    GL_RGBA, GL_UNSIGNED_BYTE, rgba.constBits());
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    row->used += width;
+    row->keys.append(key);
+    m_entries[key] = entry;
+    return entry;
+}
+
+void TextureCache::bind()
+{
+    glBindTexture(GL_TEXTURE_2D, m_texture);
 }
@@ -3,31 +3,56 @@
 
 #include <QGLContext>
 #include <QHash>
-#include <QMultiMap>
+#include <QImage>
+#include <QRectF>
+#include <QVector>
 
+// packs labels into rows of a single texture, rows are evicted as a whole in lru order
 class TextureCache
 {
 public:
+    struct Entry {
+        QRectF texCoords;
+        QSize size;
+    };
+
     explicit TextureCache(QGLContext *context);
     ~TextureCache();
 
-    bool find(const QString &key, GLuint *textureId, QPixmap *pixmap);
-    GLuint insert(const QString &key, const QPixmap &pixmap);
-    void remove(const QString &key);
-private:
-    int calcSize(const QPixmap &pixmap);
+    void beginFrame(int rowHeight);
+    const Entry *find(const QString &key);
+    const Entry *insert(const QString &key, const QImage &image);
+    void bind();
 
-    struct TextureEntry {
-        GLuint textureId;
-        qint64 lastUsed;
-        QPixmap pixmap;
+private:
+    struct Row;
+    struct AtlasEntry : public Entry {
+        Row *row;
+    };
+    struct Row {
+        int y;
+        int used;
+        qint64 lastFrame;
+        QVector<QString> keys;
+        Row *prev;
+        Row *next;
     };
 
+    void reset(int rowHeight);
+    void touch(Row *row);
+    void unlink(Row *row);
+    void evict(Row *row);
+
     QGLContext *m_context;
-    QHash<QString, TextureEntry*> m_entries;
-    QMultiMap<qint64, QString> m_lastUsed;
-    int m_cacheSize;
-    const int m_sizeLimit;
+    GLuint m_texture;
+    const int m_size;
+    int m_rowHeight;
+    qint64 m_frame;
+    QVector<Row> m_rows;
+    // most recently used row first
+    Row *m_head;
+    Row *m_tail;
+    QHash<QString, AtlasEntry*> m_entries;
 };
 
 #endif // TEXTURECACHE_H
@@ -21,6 +21,7 @@
 #include "config.h"
 #include "mainwindow.h"
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QDir>
 #include <QIcon>
 
@@ -36,8 +37,39 @@ int main(int argc, char* argv[])
 
     QDir::addSearchPath("icon", QString(ERFORCE_DATADIR) + "/icons");
 
-    MainWindow window;
-    window.show();
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Ra");
+    parser.addHelpOption();
+    QCommandLineOption remoteOption("remote", "Show the status stream of a remote ra, "
+                                    "<address> is host:port or local:name.", "address");
+    parser.addOption(remoteOption);
+    QCommandLineOption channelsOption("channels", "Comma separated list of data to receive from a remote ra: "
+                                      "field, plots, debug. Defaults to all.", "channels", "field,plots,debug");
+    parser.addOption(channelsOption);
+    QCommandLineOption serveOption("serve", "Serve the status stream on <port> for remote clients.", "port");
+    parser.addOption(serveOption);
+    QCommandLineOption headlessOption("headless", "Don't show the main window, use together with --serve.");
+    parser.addOption(headlessOption);
+    parser.process(app);
+
+    amun::StatusSubscription subscription;
+    const QStringList channels = parser.value(channelsOption).split(',', QString::SkipEmptyParts);
+    subscription.set_field(channels.contains("field"));
+    subscription.set_plots(channels.contains("plots"));
+    if (channels.contains("debug")) {
+        subscription.add_debug_source(amun::StrategyBlue);
+        subscription.add_debug_source(amun::StrategyYellow);
+        subscription.add_debug_source(amun::Controller);
+        subscription.add_debug_source(amun::Autoref);
+    }
+
+    MainWindow window(parser.value(remoteOption), subscription);
+    if (parser.isSet(serveOption)) {
+        window.serveStatus(parser.value(serveOption).toUShort());
+    }
+    if (!parser.isSet(headlessOption)) {
+        window.show();
+    }
 
     return app.exec();
 }
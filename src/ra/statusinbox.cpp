@@ -0,0 +1,148 @@
+/***************************************************************************
+ *   Copyright 2016 Robotics Erlangen e.V.                                 *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include "statusinbox.h"
+#include <google/protobuf/descriptor.h>
+#include <vector>
+
+/*!
+ * \class StatusInbox
+ * \ingroup ra
+ * \brief Bounded status queue, coalesces states arriving faster than needed
+ *
+ * The newest status is always kept. A status which only contains continuously
+ * updated state, like the world state or the debug values without log messages,
+ * replaces the previously queued status if that one has the same content type
+ * and is less than sampleInterval older. This keeps enough states for drawing
+ * traces. If the consumer doesn't drain the inbox in time, the oldest of these
+ * statuses are dropped. Statuses with other content are never coalesced or
+ * dropped.
+ */
+
+/*!
+ * \brief Creates an inbox
+ * \param capacity Maximum number of statuses kept until the next \ref take
+ * \param sampleInterval Minimal time between two kept states, in ns
+ */
+StatusInbox::StatusInbox(int capacity, qint64 sampleInterval) :
+    m_capacity(capacity),
+    m_sampleInterval(sampleInterval),
+    m_anchorTime(0),
+    m_coalesced(0),
+    m_dropped(0)
+{
+}
+
+static bool isStateField(int number)
+{
+    switch (number) {
+    case amun::Status::kTimeFieldNumber:
+    case amun::Status::kWorldStateFieldNumber:
+    case amun::Status::kGameStateFieldNumber:
+    case amun::Status::kDebugFieldNumber:
+    case amun::Status::kTimingFieldNumber:
+    case amun::Status::kRadioCommandFieldNumber:
+    case amun::Status::kUserInputBlueFieldNumber:
+    case amun::Status::kUserInputYellowFieldNumber:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/*!
+ * \brief Checks whether newer contains everything older would provide
+ */
+bool StatusInbox::isReplaceable(const amun::Status &older, const amun::Status &newer)
+{
+    std::vector<const google::protobuf::FieldDescriptor *> olderFields;
+    std::vector<const google::protobuf::FieldDescriptor *> newerFields;
+    older.GetReflection()->ListFields(older, &olderFields);
+    newer.GetReflection()->ListFields(newer, &newerFields);
+    if (olderFields != newerFields) {
+        return false;
+    }
+    for (std::size_t i = 0; i < olderFields.size(); i++) {
+        if (!isStateField(olderFields[i]->number())) {
+            return false;
+        }
+    }
+    // log messages must not be lost, debug values are only replaced by ones of the same source
+    if (older.has_debug() && (older.debug().log_size() > 0 || older.debug().source() != newer.debug().source())) {
+        return false;
+    }
+    return true;
+}
+
+qint64 StatusInbox::sampleTime(const amun::Status &status)
+{
+    return (status.has_world_state()) ? status.world_state().time() : status.time();
+}
+
+/*!
+ * \brief Queue a status
+ */
+void StatusInbox::push(const Status &status)
+{
+    m_latest = status;
+    const qint64 time = sampleTime(*status);
+
+    // time may jump backwards while seeking in a log
+    if (!m_samples.isEmpty() && time >= m_anchorTime && time - m_anchorTime < m_sampleInterval
+            && isReplaceable(*m_samples.last(), *status)) {
+        m_samples.last() = status;
+        m_coalesced++;
+        return;
+    }
+
+    m_samples.append(status);
+    m_anchorTime = time;
+    if (m_samples.size() > m_capacity) {
+        // drop the oldest status which only contains state, the newest one is always kept
+        for (int i = 0; i < m_samples.size() - 1; i++) {
+            // a status that a newer one of the same kind could replace has no unique content
+            if (isReplaceable(*m_samples.at(i), *m_samples.at(i))) {
+                m_samples.removeAt(i);
+                m_dropped++;
+                break;
+            }
+        }
+    }
+}
+
+/*!
+ * \brief Removes and returns all queued statuses, oldest first
+ */
+QList<Status> StatusInbox::take()
+{
+    QList<Status> samples;
+    samples.swap(m_samples);
+    return samples;
+}
+
+/*!
+ * \brief Drops all statuses including the latest one
+ */
+void StatusInbox::clear()
+{
+    m_samples.clear();
+    m_latest.clear();
+    m_anchorTime = 0;
+}
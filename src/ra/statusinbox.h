@@ -0,0 +1,60 @@
+/***************************************************************************
+ *   Copyright 2016 Robotics Erlangen e.V.                                 *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef STATUSINBOX_H
+#define STATUSINBOX_H
+
+#include "protobuf/status.h"
+#include <QList>
+
+//! Bounded status queue, coalesces states arriving faster than needed
+class StatusInbox
+{
+public:
+    StatusInbox(int capacity, qint64 sampleInterval);
+
+public:
+    void push(const Status &status);
+    QList<Status> take();
+    void clear();
+
+    bool isEmpty() const { return m_samples.isEmpty(); }
+    const Status &latest() const { return m_latest; }
+    //! Number of states replaced by a newer one within the sample interval
+    quint64 coalesced() const { return m_coalesced; }
+    //! Number of states dropped as the consumer didn't keep up
+    quint64 dropped() const { return m_dropped; }
+
+private:
+    static bool isReplaceable(const amun::Status &older, const amun::Status &newer);
+    static qint64 sampleTime(const amun::Status &status);
+
+private:
+    const int m_capacity;
+    const qint64 m_sampleInterval;
+    QList<Status> m_samples;
+    Status m_latest;
+    // time of the last appended sample
+    qint64 m_anchorTime;
+    quint64 m_coalesced;
+    quint64 m_dropped;
+};
+
+#endif // STATUSINBOX_H
@@ -92,6 +92,13 @@ void TeamWidget::init(bool blue)
     debugAction->setCheckable(true);
     connect(debugAction, SIGNAL(toggled(bool)), SLOT(sendEnableDebug(bool)));
 
+    reload_menu->addSeparator();
+    QAction *profileAction = reload_menu->addAction("Enable profiling");
+    profileAction->setCheckable(true);
+    connect(profileAction, SIGNAL(toggled(bool)), SLOT(sendEnableProfiling(bool)));
+    QAction *saveProfileAction = reload_menu->addAction("Save profile...");
+    connect(saveProfileAction, SIGNAL(triggered()), SLOT(saveProfile()));
+
     m_btnReload = new QToolButton;
     m_btnReload->setToolTip("Reload script");
     m_btnReload->setIcon(QIcon("icon:32/view-refresh.png"));
@@ -384,6 +391,36 @@ void TeamWidget::sendEnableDebug(bool enable)
     sendCommand(command);
 }
 
+void TeamWidget::sendEnableProfiling(bool enable)
+{
+    Command command(new amun::Command);
+    amun::CommandStrategy *strategy = m_blue ?
+                command->mutable_strategy_blue() :
+                command->mutable_strategy_yellow();
+
+    amun::CommandStrategyProfiler *profiler = strategy->mutable_profiler();
+    profiler->set_enable(enable);
+    // start a new session
+    profiler->set_reset(enable);
+    emit sendCommand(command);
+}
+
+void TeamWidget::saveProfile()
+{
+    QString filename = QFileDialog::getSaveFileName(this, "Save profile", QString(), QString("Collapsed stacks (*.folded)"), 0, 0);
+    if (filename.isNull()) {
+        return;
+    }
+
+    Command command(new amun::Command);
+    amun::CommandStrategy *strategy = m_blue ?
+                command->mutable_strategy_blue() :
+                command->mutable_strategy_yellow();
+
+    strategy->mutable_profiler()->set_export_file(filename.toStdString());
+    emit sendCommand(command);
+}
+
 void TeamWidget::updateStyleSheet()
 {
     // update background and border color
@@ -59,6 +59,8 @@ private slots:
     void sendReload();
     void sendAutoReload();
     void sendEnableDebug(bool enable);
+    void sendEnableProfiling(bool enable);
+    void saveProfile();
 
 private:
     void open(const QString &filename);
@@ -19,14 +19,17 @@
  ***************************************************************************/
 
 #include "timingwidget.h"
+#include "guitimer.h"
 #include "ui_timingwidget.h"
+#include "core/timer.h"
 #include <QSettings>
-#include <QTimer>
 #include <google/protobuf/descriptor.h>
 
 TimingWidget::TimingWidget(QWidget *parent) :
     QWidget(parent),
-    ui(new Ui::TimingWidget)
+    ui(new Ui::TimingWidget),
+    m_radioUpdated(false),
+    m_lastUpdate(0)
 {
     ui->setupUi(this);
 
@@ -48,9 +51,9 @@ TimingWidget::TimingWidget(QWidget *parent) :
         m_model->appendRow(QList<QStandardItem*>() << key << time << frequency);
     }
 
-    QTimer *timer = new QTimer(this); // update view once every second
-    connect(timer, SIGNAL(timeout()), SLOT(updateModel()));
-    timer->start(1000);
+    // update view once every second, may be slowed down while in the background
+    m_guiTimer = new GuiTimer(1000, this);
+    connect(m_guiTimer, &GuiTimer::timeout, this, &TimingWidget::updateModel);
     updateModel(); // initial update
 
     QSettings s; // remember column sizes
@@ -85,18 +88,137 @@ void TimingWidget::handleStatus(const Status &status)
             }
         }
     }
+
+    if (status->has_radio()) {
+        m_radio = status->radio();
+        m_radioUpdated = true;
+    }
+
+    if (status->has_timing() || status->has_radio()) {
+        // start measuring once the first status arrives
+        if (m_lastUpdate == 0) {
+            m_lastUpdate = Timer::systemTime();
+        }
+        m_guiTimer->requestTriggering();
+    }
 }
 
 void TimingWidget::updateModel()
 {
-    for (int i = 0; i < m_model->rowCount(); i++) {
+    // the timer interval isn't exact, scale the iterations to one second
+    const qint64 curTime = Timer::systemTime();
+    const double elapsed = qMax(curTime - m_lastUpdate, (qint64)1) * 1E-9;
+
+    bool hasValues = false;
+    // the rows after the timing fields belong to the radio statistics
+    const int timingRows = amun::Timing::descriptor()->field_count();
+    for (int i = 0; i < timingRows; i++) {
         const Value value = m_values.take(i); // remove value
         QString text;
 
         text = QString::number(value.time * 1E3, 'f', 3); // time in ms
         m_model->item(i, 1)->setText(text);
 
-        text = QString::number(value.iterations);
+        text = QString::number(qRound(value.iterations / elapsed));
         m_model->item(i, 2)->setText(text);
+
+        hasValues = hasValues || value.iterations > 0;
+    }
+
+    updateRadio();
+
+    // update once more to show that the components have stopped
+    if (hasValues) {
+        m_lastUpdate = curTime;
+        m_guiTimer->requestTriggering();
+    } else {
+        m_lastUpdate = 0;
+    }
+}
+
+int TimingWidget::radioRow(const QString &name)
+{
+    if (!m_radioRows.contains(name)) {
+        QStandardItem *key = new QStandardItem(name);
+        QStandardItem *time = new QStandardItem;
+        time->setTextAlignment(Qt::AlignRight);
+        QStandardItem *frequency = new QStandardItem;
+        frequency->setTextAlignment(Qt::AlignRight);
+        m_model->appendRow(QList<QStandardItem*>() << key << time << frequency);
+        m_radioRows[name] = m_model->rowCount() - 1;
+    }
+    return m_radioRows[name];
+}
+
+static QString latencyBucketName(const amun::StatusRadio &radio, int bucket)
+{
+    if (bucket < radio.latency_bucket_size()) {
+        return QString("<= %1 ms").arg(radio.latency_bucket(bucket) * 1E3);
+    }
+    return QString("> %1 ms").arg(radio.latency_bucket(radio.latency_bucket_size() - 1) * 1E3);
+}
+
+void TimingWidget::updateRadio()
+{
+    // the statistics are only published about once per second, keep showing them until replaced
+    if (!m_radioUpdated) {
+        return;
+    }
+    m_radioUpdated = false;
+
+    // clear values from the previous sample, rows of robots which don't respond anymore stay empty
+    foreach (int row, m_radioRows) {
+        m_model->item(row, 1)->setText(QString());
+        m_model->item(row, 2)->setText(QString());
+    }
+
+    if (m_radio.robot_size() == 0 && m_radio.usb_queue_depth_size() == 0) {
+        return;
+    }
+
+    foreach (const amun::StatusRadioRobot &robot, m_radio.robot()) {
+        const int row = radioRow(QString("radio %1-%2").arg(robot.generation()).arg(robot.id()));
+
+        // time column shows the latency 90% of the responses stay below
+        quint32 count = 0;
+        int bucket = 0;
+        for (; bucket < robot.latency_size(); bucket++) {
+            count += robot.latency(bucket);
+            if (count >= robot.responses() * 0.9f) {
+                break;
+            }
+        }
+
+        QString toolTip = QString("%1 responses, %2 lost frames\nLatency:").arg(robot.responses()).arg(robot.lost_frames());
+        for (int i = 0; i < robot.latency_size(); i++) {
+            toolTip += QString("\n  %1: %2").arg(latencyBucketName(m_radio, i)).arg(robot.latency(i));
+        }
+        toolTip += "\nConsecutive lost frames:";
+        for (int i = 0; i < robot.loss_run_size(); i++) {
+            const QString prefix = (i == robot.loss_run_size() - 1) ? ">= " : "";
+            toolTip += QString("\n  %1%2: %3").arg(prefix).arg(i + 1).arg(robot.loss_run(i));
+        }
+
+        m_model->item(row, 1)->setText(bucket < robot.latency_size() && robot.responses() > 0 ? latencyBucketName(m_radio, bucket) : QString());
+        m_model->item(row, 2)->setText(QString::number(robot.responses()));
+        for (int column = 0; column < 3; column++) {
+            m_model->item(row, column)->setToolTip(toolTip);
+        }
+    }
+
+    // usb queue depth, the time column shows the maximum depth
+    const int row = radioRow("radio usb queue");
+    QString toolTip = "Transfers in flight when sending:";
+    int maxDepth = 0;
+    for (int i = 0; i < m_radio.usb_queue_depth_size(); i++) {
+        if (m_radio.usb_queue_depth(i) > 0) {
+            maxDepth = i;
+        }
+        toolTip += QString("\n  %1: %2").arg(i).arg(m_radio.usb_queue_depth(i));
+    }
+    m_model->item(row, 1)->setText(QString::number(maxDepth));
+    m_model->item(row, 2)->setText(QString::number(m_radio.frames()));
+    for (int column = 0; column < 3; column++) {
+        m_model->item(row, column)->setToolTip(toolTip);
     }
 }
@@ -25,6 +25,7 @@
 #include <QStandardItemModel>
 #include <QWidget>
 
+class GuiTimer;
 namespace Ui {
 class TimingWidget;
 }
@@ -43,6 +44,10 @@ public slots:
 private slots:
     void updateModel();
 
+private:
+    void updateRadio();
+    int radioRow(const QString &name);
+
 private:
     struct Value
     {
@@ -54,6 +59,11 @@ private:
     Ui::TimingWidget *ui;
     QStandardItemModel *m_model;
     QMap<int, Value> m_values;
+    amun::StatusRadio m_radio;
+    bool m_radioUpdated;
+    QMap<QString, int> m_radioRows;
+    GuiTimer *m_guiTimer;
+    qint64 m_lastUpdate;
 };
 
 #endif // TIMINGWIDGET_H
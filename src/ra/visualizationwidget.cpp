@@ -121,6 +121,10 @@ void VisualizationWidget::handleStatus(const Status &status)
                 m_model->appendRow(item);
                 // new visualizations are rarely added, just sort everything
                 m_model->sort(0);
+                // let the strategy drop the visualization if it is disabled
+                if (item->checkState() != Qt::Checked) {
+                    sendVisualizationFilter();
+                }
             }
 
             // mark as visible
@@ -152,9 +156,13 @@ void VisualizationWidget::clearItems()
 void VisualizationWidget::invalidateItems()
 {
     foreach (const HashMap::mapped_type &p, m_items) {
+        QStandardItem *item = p.first;
+        // disabled entries are filtered by the strategy and thus never updated
+        if (item->checkState() != Qt::Checked) {
+            continue;
+        }
         // entries that havn't been updated for 0.5s are greyed out
         if (m_time - p.second > 0.5E9) {
-            QStandardItem *item = p.first;
             // only update color if neccessary
             if (!item->data(Qt::ForegroundRole).isValid()) {
                 item->setForeground(Qt::gray);
@@ -166,6 +174,24 @@ void VisualizationWidget::invalidateItems()
 void VisualizationWidget::sendItemsChanged()
 {
     emit itemsChanged(QStringList(m_selection.toList()));
+    sendVisualizationFilter();
+}
+
+void VisualizationWidget::sendVisualizationFilter()
+{
+    Command command(new amun::Command);
+    amun::CommandStrategyVisualizations *filter =
+            command->mutable_strategy_yellow()->mutable_visualizations();
+    for (const QString &name: m_selection) {
+        filter->add_enabled(name.toStdString());
+    }
+    for (HashMap::const_iterator it = m_items.constBegin(); it != m_items.constEnd(); ++it) {
+        filter->add_known(it.key().toStdString());
+    }
+
+    command->mutable_strategy_blue()->CopyFrom(command->strategy_yellow());
+    command->mutable_strategy_autoref()->CopyFrom(command->strategy_yellow());
+    emit sendCommand(command);
 }
 
 void VisualizationWidget::itemChanged(QStandardItem *item)
@@ -177,6 +203,11 @@ void VisualizationWidget::itemChanged(QStandardItem *item)
         if (!m_selection.contains(name)) {
             m_selection.insert(name);
             changed = true;
+            // the strategy only sends the visualization from now on
+            HashMap::iterator it = m_items.find(name.toUtf8());
+            if (it != m_items.end()) {
+                it->second = m_time;
+            }
         }
     } else {
         if (m_selection.remove(name)) {
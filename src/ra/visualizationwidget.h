@@ -21,6 +21,7 @@
 #ifndef VISUALIZATIONWIDGET_H
 #define VISUALIZATIONWIDGET_H
 
+#include "protobuf/command.h"
 #include "protobuf/status.h"
 #include <QHash>
 #include <QSet>
@@ -46,6 +47,7 @@ public:
 
 signals:
     void itemsChanged(const QStringList &items);
+    void sendCommand(const Command &command);
 
 public slots:
     void handleStatus(const Status &status);
@@ -62,6 +64,7 @@ private slots:
 
 private:
     void clearForeground(QStandardItem *item) const;
+    void sendVisualizationFilter();
 
 private:
     typedef QHash<QByteArray, QPair<QStandardItem*, qint64> > HashMap;